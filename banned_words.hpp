@@ -0,0 +1,133 @@
+#pragma once
+
+#include "types.hpp"
+
+// aho-corasick automaton over the banned word list, built once and then only read so it can be shared between threads.
+// matching is ascii case insensitive and every occurrence counts, overlapping ones too
+struct Banned_Word_Matcher
+{
+    struct Scan
+    {
+        int state    {0};
+        int duration {0};
+        bool found   {false};
+    };
+
+    Banned_Word_Matcher(const Vector<Pair<String, int>>& words)
+    {
+        auto lower {[](const u8 c)
+        {
+            return (c >= 'A' && c <= 'Z') ? (u8)(c - 'A' + 'a') : c;
+        }};
+
+        // only bytes that show up in a word get their own column, everything else shares column 0
+        for(const auto& w : words)
+        {
+            for(const auto c : w.first)
+            {
+                const auto l {lower((u8)c)};
+                if(classes[l] == 0){
+                    classes[l] = (u8)class_count++;
+                }
+            }
+        }
+        for(int c = 'A'; c <= 'Z'; c++){
+            classes[c] = classes[c - 'A' + 'a'];
+        }
+
+        add_node();
+        for(const auto& w : words)
+        {
+            if(w.first.empty()){
+                continue;
+            }
+            int node {0};
+            for(const auto c : w.first)
+            {
+                auto& n {next[node * class_count + classes[(u8)c]]};
+                if(n == -1)
+                {
+                    const auto created {add_node()};
+                    next[node * class_count + classes[(u8)c]] = created;
+                    node = created;
+                }
+                else{
+                    node = n;
+                }
+            }
+            duration[node] += w.second;
+            match[node] = true;
+        }
+
+        // breadth first so a node's fail link is finished before its children need it,
+        // missing edges are filled in so the scan never has to follow fail links
+        Vector<int> fail(match.size(), 0);
+        Vector<int> queue;
+        queue.reserve(match.size());
+        for(int c = 0; c < class_count; c++)
+        {
+            auto& n {next[c]};
+            if(n == -1){
+                n = 0;
+            }
+            else{
+                queue.push_back(n);
+            }
+        }
+        for(size_t i = 0; i < queue.size(); i++)
+        {
+            const auto node {queue[i]};
+            duration[node] += duration[fail[node]];
+            match[node] = match[node] || match[fail[node]];
+            for(int c = 0; c < class_count; c++)
+            {
+                auto& n {next[node * class_count + c]};
+                const auto fallback {next[fail[node] * class_count + c]};
+                if(n == -1){
+                    n = fallback;
+                }
+                else
+                {
+                    fail[n] = fallback;
+                    queue.push_back(n);
+                }
+            }
+        }
+    }
+
+    // text can be fed in pieces, the scan carries the state across them
+    void feed(Scan* scan, const String_View text) const
+    {
+        auto state {scan->state};
+        for(const auto c : text)
+        {
+            state = next[state * class_count + classes[(u8)c]];
+            if(match[state])
+            {
+                scan->found = true;
+                scan->duration += duration[state];
+            }
+        }
+        scan->state = state;
+    }
+
+    size_t size() const
+    {
+        return match.size();
+    }
+
+    private:
+        int add_node()
+        {
+            next.resize(next.size() + class_count, -1);
+            duration.push_back(0);
+            match.push_back(false);
+            return (int)match.size() - 1;
+        }
+
+        u8 classes[256] {};
+        int class_count {1};
+        Vector<int> next;
+        Vector<int> duration;
+        Vector<u8> match;
+};
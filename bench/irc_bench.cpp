@@ -0,0 +1,192 @@
+// old parse_message against parse_irc_message over sample chat, built by hand like the bot:
+//
+//     g++ -std=c++17 -O2 bench/irc_bench.cpp -o irc_bench && ./irc_bench bench/data/irc_lines.txt
+
+#include "../types.hpp"
+#include "../utilities.hpp"
+#include "../irc.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace old
+{
+    const String broadcaster_badge {"broadcaster"};
+    const String moderator_badge   {"moderator"};
+    const String vip_badge         {"vip"};
+    const String founder_badge     {"founder"};
+    const String subscriber_badge  {"subscriber"};
+
+    struct Parsed_Message
+    {
+        String host;
+        String nick;
+        String message;
+        String user_id;
+        String badges;
+        bool reply;
+    };
+
+    // as it was in main.cpp before irc.hpp
+    Parsed_Message parse_message(const String& msg)
+    {
+        if(msg.find("PRIVMSG") == msg.npos){
+            return {};
+        }
+
+        auto get_host {[&]()
+        {
+            auto colon {msg.find(" :") + 2};
+            return msg.substr(colon, msg.find(" ", colon + 1) - colon);
+        }};
+
+        auto get_nick {[&]()
+        {
+            auto colon {msg.find(" :") + 2};
+            return msg.substr(colon, msg.find("!", colon + 1) - colon);
+        }};
+
+        auto get_message_start {[&]()
+        {
+            auto fc {msg.find(" :")};
+            auto colon {msg.find(" :", fc + 2)};
+            return colon + 2;
+        }};
+
+        auto get_message {[&]()
+        {
+            return msg.substr(get_message_start(), msg.npos);
+        }};
+
+        auto get_badges {[&]()
+        {
+            const auto badge_badge {"badges="};
+            auto b_pos {msg.find(badge_badge)};
+            const auto bl {strlen(badge_badge)};
+            Vector<String> badges {moderator_badge, broadcaster_badge, vip_badge, founder_badge, subscriber_badge};
+            String result;
+            if(b_pos != String::npos)
+            {
+                const auto semi_colon {msg.find(';', b_pos + bl + 1)};
+                auto start {b_pos + bl};
+                auto badge {msg.find("/", start)};
+                while(badge != String::npos)
+                {
+                    result += msg.substr(start, badge - start);
+                    result += " ";
+                    start = badge + 2;
+                    if(start >= semi_colon){
+                        break;
+                    }
+                    badge = msg.find("/", start);
+                }
+            }
+
+            return result;
+        }};
+
+        auto get_user_id {[&]()
+        {
+            const auto user_id {"user-id="};
+            auto pos {msg.find(user_id)};
+            pos += 8;
+            return msg.substr(pos, msg.find(';', pos) - pos);
+        }};
+
+        Parsed_Message result;
+
+        result.host = get_host();
+        result.nick = get_nick();
+        result.message = get_message();
+        result.badges = get_badges();
+        result.user_id = get_user_id();
+        {
+            auto r {msg.find("reply")};
+            result.reply = r != String::npos && r < get_message_start();
+        }
+
+        clean_line(&result.host);
+        clean_line(&result.nick);
+        clean_line(&result.message);
+        clean_line(&result.badges);
+        clean_line(&result.user_id);
+
+        return result;
+    }
+}
+
+int main(int args, const char** argc)
+{
+    const char* path {args > 1 ? argc[1] : "bench/data/irc_lines.txt"};
+    Vector<String> lines;
+    {
+        std::ifstream file {path};
+        String line;
+        while(std::getline(file, line))
+        {
+            if(!line.empty()){
+                lines.push_back(line + "\r\n");
+            }
+        }
+    }
+    if(lines.empty())
+    {
+        printf("no lines in %s\n", path);
+        return 1;
+    }
+    size_t bytes {0};
+    for(const auto& l : lines){
+        bytes += l.size();
+    }
+
+    constexpr int rounds {500};
+    // summed so the work can't be optimized away, and to check both saw the same messages
+    u64 old_sum {0};
+    u64 new_sum {0};
+
+    Timer old_timer;
+    old_timer.start();
+    for(int r = 0; r < rounds; r++)
+    {
+        for(const auto& l : lines)
+        {
+            const auto m {old::parse_message(l)};
+            old_sum += m.nick.size() + m.message.size() + m.user_id.size() + m.reply;
+        }
+    }
+    const auto old_seconds {old_timer.elapsed()};
+
+    Timer new_timer;
+    new_timer.start();
+    Irc_Message irc;
+    for(int r = 0; r < rounds; r++)
+    {
+        for(const auto& l : lines)
+        {
+            String_View frame {l};
+            while(!frame.empty())
+            {
+                const auto line {irc_next_line(&frame)};
+                if(!parse_irc_message(line, &irc) || irc.command != "PRIVMSG" || irc.trailing.empty()){
+                    continue;
+                }
+                // what parse_message in main.cpp takes out of it
+                const auto user_id {irc.get_tag("user-id")};
+                const auto badges {parse_badges(irc.get_tag("badges"))};
+                const auto reply {irc.has_tag("reply-parent-msg-id")};
+                new_sum += irc.nick.size() + irc.trailing.size() + user_id.size() + reply + (badges & 0);
+            }
+        }
+    }
+    const auto new_seconds {new_timer.elapsed()};
+
+    const auto messages {(double)lines.size() * rounds};
+    printf("%zu lines, %zu bytes, %i rounds\n", lines.size(), bytes, rounds);
+    printf("old parse_message   %8.1f ns/line\n", old_seconds / messages * 1e9);
+    printf("parse_irc_message   %8.1f ns/line\n", new_seconds / messages * 1e9);
+    printf("speedup             %8.1fx\n", old_seconds / new_seconds);
+    if(old_sum != new_sum){
+        printf("results differ %llu %llu\n", (unsigned long long)old_sum, (unsigned long long)new_sum);
+    }
+    return 0;
+}
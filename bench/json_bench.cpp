@@ -0,0 +1,241 @@
+// the naive json lookups main.cpp used against json_read over a follower page and an EventSub notification,
+// built by hand like the bot. -mavx2 or -U__SSE2__ pick the other json_index paths:
+//
+//     g++ -std=c++17 -O2 bench/json_bench.cpp -o json_bench && ./json_bench bench/data
+
+#include "../types.hpp"
+#include "../utilities.hpp"
+#include "../json.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace old
+{
+    // as they were in json.hpp before json_read
+    inline String_View json_get_view_naive(const String_View key, const String_View data)
+    {
+        size_t colon {0};
+        size_t quote {0};
+        size_t quote_2 {0};
+
+        constexpr auto npos {String_View::npos};
+
+        auto get_valid_colon_helper {[&]()
+        {
+            colon = data.find(':', colon + 1);
+            quote = data.find('"', quote_2 + 1);
+            quote_2 = data.find('"', quote + 1);
+            while(colon > quote && colon < quote_2)
+            {
+                colon = data.find(':', quote_2);
+                quote = data.find('"', quote_2 + 1);
+                quote_2 = data.find('"', quote + 1);
+                if(colon == npos){
+                    break;
+                }
+            }
+        }};
+
+        auto get_value {[&]()
+        {
+            String_View result;
+            while(true)
+            {
+                get_valid_colon_helper();
+                if(colon != npos)
+                {
+                    auto q {data.rfind('"', colon - 1)};
+                    auto q2 {data.rfind('"', q - 1)};
+                    auto k {data.substr(q2 + 1, (q - q2) - 1)};
+                    if(k == key)
+                    {
+                        q = data.find('"', colon);
+                        q2 = data.find('"', q + 1);
+                        result = data.substr(q + 1, (q2 - q) - 1);
+                        break;
+                    }
+                }
+                else {
+                    break;
+                }
+            }
+            return result;
+        }};
+
+        return get_value();
+    }
+
+    inline String json_get_value_naive(const String& key, const String& data)
+    {
+        return String{json_get_view_naive(key, data)};
+    }
+
+    inline bool json_next_object(String_View* array, String_View* object)
+    {
+        auto& a {*array};
+        size_t begin {0};
+        while(begin < a.size() && a[begin] != '{')
+        {
+            if(a[begin] == ']')
+            {
+                a.remove_prefix(begin + 1);
+                return false;
+            }
+            begin++;
+        }
+
+        int depth {0};
+        bool in_string {false};
+        for(size_t i = begin; i < a.size(); i++)
+        {
+            const auto c {a[i]};
+            if(in_string)
+            {
+                if(c == '\\'){
+                    i++;
+                }
+                else if(c == '"'){
+                    in_string = false;
+                }
+            }
+            else if(c == '"'){
+                in_string = true;
+            }
+            else if(c == '{'){
+                depth++;
+            }
+            else if(c == '}' && --depth == 0)
+            {
+                *object = a.substr(begin, i - begin + 1);
+                a.remove_prefix(i + 1);
+                return true;
+            }
+        }
+        a = {};
+        return false;
+    }
+
+    // one page of fetch_followers
+    u64 read_followers(const String_View page)
+    {
+        u64 sum {0};
+        String_View rest {page};
+        const auto data {rest.find("\"data\"")};
+        rest.remove_prefix(data == String_View::npos ? rest.size() : data);
+
+        String_View record;
+        while(json_next_object(&rest, &record))
+        {
+            sum += parse_timestamp(json_get_view_naive("followed_at", record)) & 0xff;
+            sum += json_get_view_naive("user_id", record).size();
+            sum += json_get_view_naive("user_login", record).size();
+        }
+        sum += json_get_view_naive("cursor", rest).size();
+        return sum;
+    }
+
+    // the lookups handle_event_sub_message did for a follow
+    u64 read_event(const String& data)
+    {
+        u64 sum {0};
+        sum += json_get_value_naive("message_type", data).size();
+        sum += json_get_value_naive("subscription_type", data).size();
+        sum += json_get_value_naive("user_name", data).size();
+        sum += json_get_value_naive("user_id", data).size();
+        return sum;
+    }
+}
+
+u64 read_followers(const String_View page)
+{
+    u64 sum {0};
+    Json_Value total;
+    Json_Value cursor;
+    Json_Value followed_at;
+    Json_Value user_id;
+    Json_Value user_login;
+    json_read_each(page, {{"total", &total}, {"pagination.cursor", &cursor}},
+                   "data", {{"followed_at", &followed_at}, {"user_id", &user_id}, {"user_login", &user_login}}, [&]
+    {
+        sum += parse_timestamp(followed_at.view()) & 0xff;
+        sum += user_id.view().size();
+        sum += user_login.view().size();
+        return true;
+    });
+    sum += cursor.view().size();
+    return sum;
+}
+
+u64 read_event(const String& data)
+{
+    Json_Value message_type;
+    Json_Value subscription_type;
+    Json_Value user_name;
+    Json_Value user_id;
+    json_read(data, {{"metadata.message_type", &message_type},
+                     {"metadata.subscription_type", &subscription_type},
+                     {"payload.event.user_name", &user_name},
+                     {"payload.event.user_id", &user_id}});
+    return message_type.string().size() + subscription_type.string().size() + user_name.string().size() + user_id.string().size();
+}
+
+String read_file(const String& path)
+{
+    std::ifstream file {path, std::ios::binary};
+    std::stringstream s;
+    s << file.rdbuf();
+    return s.str();
+}
+
+int main(int args, const char** argc)
+{
+    const String dir {args > 1 ? argc[1] : "bench/data"};
+    const auto page {read_file(dir + "/followers_page.json")};
+    const auto event {read_file(dir + "/eventsub_follow.json")};
+    if(page.empty() || event.empty())
+    {
+        printf("no followers_page.json or eventsub_follow.json in %s\n", dir.c_str());
+        return 1;
+    }
+
+#if defined(__AVX2__)
+    const char* path {"avx2"};
+#elif defined(JSON_SSE2)
+    const char* path {"sse2"};
+#else
+    const char* path {"scalar"};
+#endif
+
+    // summed so the work can't be optimized away, and to check both read the same values
+    auto time {[](const char* name, const int rounds, const size_t bytes, auto&& f)
+    {
+        u64 sum {0};
+        Timer t;
+        t.start();
+        for(int r = 0; r < rounds; r++){
+            sum += f();
+        }
+        const auto seconds {t.elapsed()};
+        printf("%-28s %10.1f us %8.2f GB/s\n", name, seconds / rounds * 1e6, bytes * (double)rounds / seconds / 1e9);
+        return Pair<double, u64>{seconds, sum};
+    }};
+
+    printf("json_index path %s\n", path);
+    printf("followers_page.json, %zu bytes\n", page.size());
+    const auto old_page {time("  naive per record", 2000, page.size(), [&]{ return old::read_followers(page); })};
+    const auto new_page {time("  json_read_each", 2000, page.size(), [&]{ return read_followers(page); })};
+    Vector<u32> index;
+    time("  json_index alone", 20000, page.size(), [&]{ json_index(page, &index); return (u64)index.size(); });
+    printf("  speedup %.1fx\n", old_page.first / new_page.first);
+
+    printf("eventsub_follow.json, %zu bytes\n", event.size());
+    const auto old_event {time("  naive per key", 200000, event.size(), [&]{ return old::read_event(event); })};
+    const auto new_event {time("  json_read", 200000, event.size(), [&]{ return read_event(event); })};
+    printf("  speedup %.1fx\n", old_event.first / new_event.first);
+
+    if(old_page.second != new_page.second || old_event.second != new_event.second){
+        printf("results differ\n");
+    }
+    return 0;
+}
@@ -0,0 +1,199 @@
+// the stringstream string_to_int and string_to_float against the from_chars ones, loading a recorded followers.txt
+// the way load_users_file did and on the numbers alone. built by hand like the bot:
+//
+//     g++ -std=c++17 -O2 bench/numbers_bench.cpp -o numbers_bench && ./numbers_bench bench/data/followers.txt
+
+#include "../types.hpp"
+#include "../utilities.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace old
+{
+    // as they were in utilities.hpp before from_chars
+    inline int string_to_int(const String& s)
+    {
+        std::stringstream ss {s};
+        int res;
+        ss>>res;
+        return res;
+    }
+
+    inline float string_to_float(const String& s)
+    {
+        std::stringstream ss {s};
+        float res;
+        ss>>res;
+        return res;
+    }
+}
+
+struct User
+{
+    String user_id;
+    s64 points {0};
+    s64 gamba_points {0};
+    s64 social_credit {0};
+};
+
+// load_users_file with either set of conversions, Convert sets the field from the value
+template<typename Convert>
+void load_users_file(const String& path, Vector<User>* out, Convert&& convert)
+{
+    String line;
+    String tag;
+    String value;
+
+    std::ifstream o {path};
+    User* current {nullptr};
+    while(std::getline(o, line))
+    {
+        clean_line(&line);
+        if(line != "End")
+        {
+            if(!line.empty())
+            {
+                extract_tag_and_value_from_line(line, &tag, &value);
+                if(tag == "User")
+                {
+                    out->push_back({});
+                    current = &out->back();
+                    current->user_id = value;
+                }
+                else if(!current){
+                    continue;
+                }
+                else if(tag == "Points"){
+                    convert(value, &current->points);
+                }
+                else if(tag == "Gamba_Points"){
+                    convert(value, &current->gamba_points);
+                }
+                else if(tag == "Social_Credit"){
+                    convert(value, &current->social_credit);
+                }
+            }
+        }
+    }
+}
+
+u64 sum_users(const Vector<User>& users)
+{
+    u64 sum {0};
+    for(const auto& u : users){
+        sum += u.user_id.size() + u.points + u.gamba_points + u.social_credit;
+    }
+    return sum;
+}
+
+int main(int args, const char** argc)
+{
+    const String path {args > 1 ? argc[1] : "bench/data/followers.txt"};
+
+    auto old_convert {[](const String& value, s64* out)
+    {
+        *out = old::string_to_int(value);
+    }};
+    auto new_convert {[](const String& value, s64* out)
+    {
+        string_to_int(value, out);
+    }};
+
+    // every Points, Gamba_Points and Social_Credit value in the file, for timing the conversions on their own
+    Vector<String> values;
+    {
+        Vector<User> users;
+        load_users_file(path, &users, [&](const String& value, s64*){ values.push_back(value); });
+        if(users.empty())
+        {
+            printf("no users in %s\n", path.c_str());
+            return 1;
+        }
+        printf("%s, %zu users, %zu numbers\n", path.c_str(), users.size(), values.size());
+    }
+
+    // summed so the work can't be optimized away, and to check both read the same numbers
+    auto time_load {[&](const char* name, auto&& convert)
+    {
+        constexpr int rounds {50};
+        u64 sum {0};
+        Timer t;
+        t.start();
+        for(int r = 0; r < rounds; r++)
+        {
+            Vector<User> users;
+            load_users_file(path, &users, convert);
+            sum += sum_users(users);
+        }
+        const auto seconds {t.elapsed() / rounds};
+        printf("  %-26s %10.2f ms\n", name, seconds * 1e3);
+        return Pair<double, u64>{seconds, sum};
+    }};
+
+    auto time_numbers {[&](const char* name, auto&& convert)
+    {
+        constexpr int rounds {200};
+        u64 sum {0};
+        Timer t;
+        t.start();
+        for(int r = 0; r < rounds; r++)
+        {
+            for(const auto& v : values)
+            {
+                s64 n {0};
+                convert(v, &n);
+                sum += n;
+            }
+        }
+        const auto seconds {t.elapsed()};
+        printf("  %-26s %10.1f ns per number\n", name, seconds / rounds / values.size() * 1e9);
+        return Pair<double, u64>{seconds, sum};
+    }};
+
+    printf("load_users_file\n");
+    const auto old_load {time_load("stringstream", old_convert)};
+    const auto new_load {time_load("from_chars", new_convert)};
+    printf("  speedup %.1fx\n", old_load.first / new_load.first);
+
+    printf("conversions alone\n");
+    const auto old_numbers {time_numbers("stringstream", old_convert)};
+    const auto new_numbers {time_numbers("from_chars", new_convert)};
+    printf("  speedup %.1fx\n", old_numbers.first / new_numbers.first);
+
+    // what !volume and the music volume get, there's no recording of those so these stand in
+    const Vector<String> volumes {"0.5", "1", "0.25", "0.75", "1.5", "0.1", "0.05", "2", "0.333", "1.0"};
+    printf("string_to_float over volume arguments\n");
+    constexpr int float_rounds {100000};
+    double old_float_sum {0};
+    double new_float_sum {0};
+    Timer t;
+    t.start();
+    for(int r = 0; r < float_rounds; r++)
+    {
+        for(const auto& v : volumes){
+            old_float_sum += old::string_to_float(v);
+        }
+    }
+    const auto old_float {t.elapsed()};
+    t.start();
+    for(int r = 0; r < float_rounds; r++)
+    {
+        for(const auto& v : volumes)
+        {
+            float f {0};
+            string_to_float(v, &f);
+            new_float_sum += f;
+        }
+    }
+    const auto new_float {t.elapsed()};
+    const auto float_count {(double)float_rounds * volumes.size()};
+    printf("  %-26s %10.1f ns per number\n", "stringstream", old_float / float_count * 1e9);
+    printf("  %-26s %10.1f ns per number\n", "from_chars", new_float / float_count * 1e9);
+    printf("  speedup %.1fx\n", old_float / new_float);
+
+    if(old_load.second != new_load.second || old_numbers.second != new_numbers.second || old_float_sum != new_float_sum){
+        printf("results differ\n");
+    }
+    return 0;
+}
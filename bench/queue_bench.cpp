@@ -0,0 +1,203 @@
+// erase-front vectors and a mutex guarded handoff, as main.cpp had them, against Ring_Queue and Spsc_Queue,
+// over bursts of recorded chat lines. built by hand like the bot:
+//
+//     g++ -std=c++17 -O2 -pthread bench/queue_bench.cpp -o queue_bench && ./queue_bench bench/data/irc_lines.txt
+
+#include "../types.hpp"
+#include "../utilities.hpp"
+#include "../queue.hpp"
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+// the websocket thread only ever has one burst in flight here, so both sides move the same strings back and forth
+struct Burst
+{
+    Vector<String> from;
+    Vector<String> to;
+
+    u64 swap_back()
+    {
+        u64 sum {0};
+        for(const auto& s : to){
+            sum += s.size();
+        }
+        from.swap(to);
+        return sum;
+    }
+};
+
+// priv_messages before Ring_Queue, handled from the front and erased one at a time
+u64 vector_drain(Burst* b)
+{
+    Vector<String> queue;
+    for(auto& s : b->from){
+        queue.push_back(std::move(s));
+    }
+    size_t i {0};
+    while(!queue.empty())
+    {
+        b->to[i++] = std::move(queue.front());
+        queue.erase(queue.begin());
+    }
+    return b->swap_back();
+}
+
+// kept across bursts like the members of Bot are
+u64 ring_drain(Ring_Queue<String>* queue, Burst* b)
+{
+    for(auto& s : b->from){
+        queue->push_back(std::move(s));
+    }
+    size_t i {0};
+    while(!queue->empty())
+    {
+        b->to[i++] = std::move(queue->front());
+        queue->pop_front();
+    }
+    return b->swap_back();
+}
+
+// the websocket thread pushes one burst, the message thread takes what's there each time it looks until it has
+// seen all of it. push and take are whichever handoff is being timed
+template<typename Push, typename Take>
+u64 handoff(Burst* b, const int rounds, Push&& push, Take&& take)
+{
+    std::atomic<int> round {0};
+    std::thread websocket {[&]
+    {
+        for(int r = 0; r < rounds; r++)
+        {
+            while(round.load(std::memory_order_acquire) != r){
+                std::this_thread::yield();
+            }
+            // nothing of the burst is touched after its last push, the message thread swaps it right away
+            auto from {b->from.data()};
+            const auto n {b->from.size()};
+            for(size_t i = 0; i < n; i++){
+                push(std::move(from[i]));
+            }
+        }
+    }};
+
+    u64 sum {0};
+    for(int r = 0; r < rounds; r++)
+    {
+        round.store(r, std::memory_order_release);
+        size_t received {0};
+        while(received < b->to.size())
+        {
+            received += take(b->to.data() + received);
+            if(received < b->to.size()){
+                std::this_thread::yield();
+            }
+        }
+        sum += b->swap_back();
+    }
+    websocket.join();
+    return sum;
+}
+
+int main(int args, const char** argc)
+{
+    const char* path {args > 1 ? argc[1] : "bench/data/irc_lines.txt"};
+    Vector<String> lines;
+    {
+        std::ifstream file {path};
+        String line;
+        while(std::getline(file, line))
+        {
+            if(!line.empty()){
+                lines.push_back(line + "\r\n");
+            }
+        }
+    }
+    if(lines.empty())
+    {
+        printf("no lines in %s\n", path);
+        return 1;
+    }
+
+    printf("%zu recorded lines, times are per message\n", lines.size());
+    printf("%8s %14s %14s %8s %14s %14s %8s\n", "burst", "erase front", "Ring_Queue", "", "mutex+swap", "Spsc_Queue", "");
+    for(const size_t burst : {64, 256, 1024, 4096})
+    {
+        Burst b;
+        for(size_t i = 0; i < burst; i++){
+            b.from.push_back(lines[i % lines.size()]);
+        }
+        b.to.resize(burst);
+        // about the same number of messages for every burst size
+        const int rounds {(int)(1000000 / burst)};
+        const auto total {(double)burst * rounds};
+
+        u64 vector_sum {0};
+        Timer t;
+        t.start();
+        for(int r = 0; r < rounds; r++){
+            vector_sum += vector_drain(&b);
+        }
+        const auto vector_ns {t.elapsed() / total * 1e9};
+
+        u64 ring_sum {0};
+        Ring_Queue<String> ring;
+        t.start();
+        for(int r = 0; r < rounds; r++){
+            ring_sum += ring_drain(&ring, &b);
+        }
+        const auto ring_ns {t.elapsed() / total * 1e9};
+
+        // Connection_Metadata::messages before Spsc_Queue, the message thread swapped the whole vector out
+        std::mutex message_mutex;
+        Vector<String> messages;
+        Vector<String> incoming;
+        t.start();
+        const auto mutex_sum {handoff(&b, rounds, [&](String s)
+        {
+            std::scoped_lock g {message_mutex};
+            messages.push_back(std::move(s));
+        },
+        [&](String* out)
+        {
+            {
+                std::scoped_lock g {message_mutex};
+                incoming.swap(messages);
+            }
+            for(size_t i = 0; i < incoming.size(); i++){
+                out[i] = std::move(incoming[i]);
+            }
+            const auto n {incoming.size()};
+            incoming.clear();
+            return n;
+        })};
+        const auto mutex_ns {t.elapsed() / total * 1e9};
+
+        // same size as websocket.hpp's, push waits for room like push_message does
+        Spsc_Queue<String, 4096> spsc;
+        t.start();
+        const auto spsc_sum {handoff(&b, rounds, [&](String s)
+        {
+            while(!spsc.push(std::move(s))){
+                std::this_thread::yield();
+            }
+        },
+        [&](String* out)
+        {
+            size_t n {0};
+            while(spsc.pop(out + n)){
+                n++;
+            }
+            return n;
+        })};
+        const auto spsc_ns {t.elapsed() / total * 1e9};
+
+        printf("%8zu %11.1f ns %11.1f ns %7.1fx %11.1f ns %11.1f ns %7.1fx\n", burst, vector_ns, ring_ns, vector_ns / ring_ns,
+               mutex_ns, spsc_ns, mutex_ns / spsc_ns);
+        if(vector_sum != ring_sum || mutex_sum != spsc_sum || vector_sum != mutex_sum){
+            printf("results differ\n");
+        }
+    }
+    return 0;
+}
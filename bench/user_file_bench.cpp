@@ -0,0 +1,181 @@
+// opening followers.bin and looking every user up against parsing the old followers.txt, over a generated
+// million users. both files are written to the temp directory first, built by hand like the bot:
+//
+//     g++ -std=c++17 -O2 bench/user_file_bench.cpp -o user_file_bench && ./user_file_bench 1000000
+
+#include "../types.hpp"
+#include "../utilities.hpp"
+#include "../user_file.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <random>
+#include <unordered_map>
+#include <algorithm>
+
+namespace old
+{
+    // as they were in utilities.hpp before from_chars
+    inline s64 string_to_int(const String& s)
+    {
+        std::stringstream ss {s};
+        s64 res;
+        ss>>res;
+        return res;
+    }
+
+    struct User
+    {
+        String user_id;
+        s64 points {0};
+        s64 gamba_points {0};
+        s64 social_credit {0};
+
+        void serialize_out(std::ostream* data)
+        {
+            auto& i {*data};
+            i<<"User : " <<user_id<<"\n\n";
+            i<<"\tPoints : " <<points<<"\n\n";
+            i<<"\tGamba_Points : " <<gamba_points<<"\n\n";
+            i<<"\tSocial_Credit : " <<social_credit<<"\n\n";
+        }
+    };
+
+    // as it was in main.cpp before followers.bin
+    void load_users_file(const String& path, Vector<User>* out)
+    {
+        String line;
+        String tag;
+        String value;
+
+        std::ifstream o {path};
+        User* current {nullptr};
+        while(std::getline(o, line))
+        {
+            clean_line(&line);
+            if(line != "End")
+            {
+                if(!line.empty())
+                {
+                    extract_tag_and_value_from_line(line, &tag, &value);
+                    if(tag == "User")
+                    {
+                        out->push_back({});
+                        current = &out->back();
+                        current->user_id = value;
+                    }
+                    else if(!current){
+                        continue;
+                    }
+                    else if(tag == "Points"){
+                        current->points = string_to_int(value);
+                    }
+                    else if(tag == "Gamba_Points"){
+                        current->gamba_points = string_to_int(value);
+                    }
+                    else if(tag == "Social_Credit"){
+                        current->social_credit = string_to_int(value);
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main(int args, const char** argc)
+{
+    const size_t count {args > 1 ? (size_t)std::strtoull(argc[1], nullptr, 10) : 1000000};
+    const auto dir {std::filesystem::temp_directory_path()};
+    const auto text_path {(dir / "bench_followers.txt").string()};
+    const auto binary_path {(dir / "bench_followers.bin").string()};
+
+    // twitch ids are numbers up to ten digits, stepping by a prime keeps them unique and the shuffle mixes up the order
+    Vector<String> ids;
+    ids.reserve(count);
+    {
+        std::mt19937_64 generator {11};
+        const u64 step {2654435761ull};
+        const u64 offset {generator() % 1000000000ull};
+        for(size_t i = 0; i < count; i++){
+            ids.push_back(std::to_string(10000000 + (offset + i * step) % 9000000000ull));
+        }
+        std::shuffle(ids.begin(), ids.end(), generator);
+    }
+
+    Timer t;
+    t.start();
+    {
+        std::error_code ignored;
+        std::filesystem::remove(binary_path, ignored);
+        std::ofstream text {text_path};
+        User_File file;
+        if(!file.open(binary_path)){
+            return 1;
+        }
+        std::mt19937_64 generator {25};
+        for(size_t i = 0; i < count; i++)
+        {
+            old::User u {ids[i], (s64)(generator() % 100000), (s64)(generator() % 5000), (s64)(generator() % 200) - 100};
+            u.serialize_out(&text);
+            file.put(u.user_id, u.points, u.gamba_points, u.social_credit);
+            file.set_followed_at(u.user_id, 1600000000 + (s64)i);
+        }
+        file.flush();
+    }
+    printf("%zu users, %s %.1f MB, %s %.1f MB, written in %.1fs\n", count,
+           text_path.c_str(), std::filesystem::file_size(text_path) / 1e6,
+           binary_path.c_str(), std::filesystem::file_size(binary_path) / 1e6, t.elapsed());
+    printf("both files were just written so they are in the page cache\n");
+
+    // summed so the work can't be optimized away, and to check both found the same users
+    u64 old_sum {0};
+    t.start();
+    Vector<old::User> users;
+    old::load_users_file(text_path, &users);
+    const auto old_parse {t.elapsed()};
+    // the old startup searched this list once per follower, a map is far kinder to it than that was
+    std::unordered_map<String_View, const old::User*> by_id;
+    by_id.reserve(users.size());
+    for(const auto& u : users){
+        by_id[u.user_id] = &u;
+    }
+    for(const auto& id : ids)
+    {
+        auto found {by_id.find(id)};
+        if(found != by_id.end()){
+            old_sum += found->second->points + found->second->gamba_points + found->second->social_credit;
+        }
+    }
+    const auto old_total {t.elapsed()};
+
+    u64 new_sum {0};
+    t.start();
+    User_File file;
+    if(!file.open(binary_path)){
+        return 1;
+    }
+    const auto new_open {t.elapsed()};
+    for(const auto& id : ids)
+    {
+        if(auto r {file.find(id)}){
+            new_sum += r->points + r->gamba_points + r->social_credit;
+        }
+    }
+    const auto new_total {t.elapsed()};
+
+    printf("followers.txt parse              %10.3f s\n", old_parse);
+    printf("followers.txt parse + lookups    %10.3f s\n", old_total);
+    printf("followers.bin open               %10.6f s\n", new_open);
+    printf("followers.bin open + lookups     %10.3f s\n", new_total);
+    printf("speedup to first lookup %.0fx, with every user looked up %.1fx\n", old_parse / new_open, old_total / new_total);
+    if(old_sum != new_sum){
+        printf("results differ %llu %llu\n", (unsigned long long)old_sum, (unsigned long long)new_sum);
+    }
+
+    std::error_code ignored;
+    std::filesystem::remove(text_path, ignored);
+    std::filesystem::remove(binary_path, ignored);
+    return 0;
+}
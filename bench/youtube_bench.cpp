@@ -0,0 +1,184 @@
+// the old line by line videos.list parser against parse_youtube_api_result over a recorded response, pretty printed
+// the way the api and the mock server send it. built by hand like the bot:
+//
+//     g++ -std=c++17 -O2 bench/youtube_bench.cpp -o youtube_bench && ./youtube_bench bench/data/youtube_videos.json
+
+#include "../types.hpp"
+#include "../utilities.hpp"
+#include "../youtube_api.hpp"
+#include <cstdio>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+namespace old
+{
+    // as it was in utilities.hpp before from_chars
+    inline int string_to_int(const String& s)
+    {
+        std::stringstream ss {s};
+        int res;
+        ss>>res;
+        return res;
+    }
+
+    struct Youtube_Video_Info
+    {
+        String title    {};
+        String iso_8601_duration;
+        int like_count  {-1};
+        int view_count  {-1};
+        size_t duration {0};
+    };
+
+    // as it was in youtube_api.hpp before json_read
+    Youtube_Video_Info parse_youtube_api_result(const String& s)
+    {
+        String line;
+        std::stringstream ss {s};
+
+        auto get_content {[](const String& l)
+        {
+            auto colon {l.find(':')};
+            auto first_comma {l.find('"', colon + 1)};
+            auto second_comma {l.find('"', first_comma + 1)};
+            return l.substr(first_comma + 1, (second_comma - first_comma) - 1);
+        }};
+
+        auto convert_iso_8601_to_seconds {[](const String& s)
+        {
+            auto get_number_component {[&s](size_t ctr)
+            {
+                String value;
+
+                while(isdigit(s[ctr]))
+                {
+                    value = s[ctr] + value;
+                    ctr--;
+                }
+                return string_to_int(value);
+            }};
+
+            int day_value     {0};
+            int hours_value   {0};
+            int minutes_value {0};
+            int seconds_value {0};
+
+            auto key {s.find("DT")};
+            if(key != s.npos){
+                day_value = get_number_component(key - 1);
+            }
+            key = s.find('H');
+            if(key != s.npos){
+                hours_value = get_number_component(key - 1);
+            }
+            key = s.find('M');
+            if(key != s.npos){
+                minutes_value = get_number_component(key - 1);
+            }
+            key = s.find('S');
+            if(key != s.npos){
+                seconds_value = get_number_component(key - 1);
+            }
+            return (day_value * 24 * 60 * 60) + (hours_value * 60 * 60) + (minutes_value * 60) + seconds_value;
+        }};
+
+        Youtube_Video_Info result;
+
+        auto entered_snippet         {false};
+        auto entered_content_details {false};
+        auto entered_statistics      {false};
+
+        while(std::getline(ss, line))
+        {
+            if(line.find("snippet") != String::npos){
+                entered_snippet = true;
+            }
+            else if(line.find("contentDetails") != String::npos)
+            {
+                entered_content_details = true;
+                entered_snippet = false;
+            }
+            else if(line.find("statistics") != String::npos)
+            {
+                entered_content_details = false;
+                entered_snippet = false;
+                entered_statistics = true;
+            }
+            if(entered_snippet)
+            {
+                if(line.find("title") != String::npos){
+                    result.title = get_content(line);
+                }
+            }
+            else if(entered_content_details)
+            {
+                if(line.find("duration") != String::npos)
+                {
+                    auto d {get_content(line)};
+                    result.iso_8601_duration = d;
+                    result.duration = convert_iso_8601_to_seconds(d);
+                }
+            }
+            else if(entered_statistics)
+            {
+                if(line.find("viewCount") != String::npos){
+                    result.view_count = string_to_int(get_content(line));
+                }
+                else if(line.find("likeCount") != String::npos){
+                    result.like_count = string_to_int(get_content(line));
+                }
+            }
+        }
+        return result;
+    }
+}
+
+int main(int args, const char** argc)
+{
+    const char* path {args > 1 ? argc[1] : "bench/data/youtube_videos.json"};
+    String response;
+    {
+        std::ifstream file {path, std::ios::binary};
+        std::stringstream s;
+        s << file.rdbuf();
+        response = s.str();
+    }
+    if(response.empty())
+    {
+        printf("nothing in %s\n", path);
+        return 1;
+    }
+
+    constexpr int rounds {100000};
+    // summed so the work can't be optimized away, and to check both read the same video
+    u64 old_sum {0};
+    u64 new_sum {0};
+
+    Timer old_timer;
+    old_timer.start();
+    for(int r = 0; r < rounds; r++)
+    {
+        const auto v {old::parse_youtube_api_result(response)};
+        old_sum += v.title.size() + v.iso_8601_duration.size() + v.duration + v.view_count + v.like_count;
+    }
+    const auto old_seconds {old_timer.elapsed()};
+
+    Timer new_timer;
+    new_timer.start();
+    for(int r = 0; r < rounds; r++)
+    {
+        const auto v {parse_youtube_api_result(response)};
+        new_sum += v.title.size() + v.iso_8601_duration.size() + v.duration + v.view_count + v.like_count;
+    }
+    const auto new_seconds {new_timer.elapsed()};
+
+    printf("%s, %zu bytes, %i rounds\n", path, response.size(), rounds);
+    printf("old getline parser         %8.2f us %8.2f GB/s\n", old_seconds / rounds * 1e6, response.size() * (double)rounds / old_seconds / 1e9);
+    printf("parse_youtube_api_result   %8.2f us %8.2f GB/s\n", new_seconds / rounds * 1e6, response.size() * (double)rounds / new_seconds / 1e9);
+    printf("speedup                    %8.1fx\n", old_seconds / new_seconds);
+    if(old_sum != new_sum){
+        printf("results differ %llu %llu\n", (unsigned long long)old_sum, (unsigned long long)new_sum);
+    }
+    return 0;
+}
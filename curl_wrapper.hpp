@@ -2,13 +2,29 @@
 
 #include <curl/curl.h>
 #include "types.hpp"
+#include <mutex>
+#include <atomic>
 
+// where curl_callback writes the body, straight into the caller's string.
+// appending grows it geometrically and the first chunk reserves the whole body when the server sent Content-Length
 struct CUrl_Result
 {
-    size_t size    {0};
-    char* response {nullptr};
+    String* body {nullptr};
+    CURL* handle {nullptr};
+    bool sized   {false};
 };
 
+// counted by curl_call. a transfer that didn't open a connection went out on one that was already there,
+// handshake is the connect plus tls time summed over the ones that did, so its average is what a reuse saves
+struct Curl_Stats
+{
+    std::atomic<u64> transfers       {0};
+    std::atomic<u64> new_connections {0};
+    std::atomic<u64> handshake_us    {0};
+};
+
+inline Curl_Stats curl_stats;
+
 template<typename ...Args>
 inline curl_slist* set_curl_headers(const Args&... args)
 {
@@ -22,42 +38,173 @@ inline curl_slist* set_curl_headers(const Args&... args)
 inline size_t curl_callback(void* data, size_t size, size_t nmemb, void* clientp)
 {
     auto real_size {size * nmemb};
-    auto mem {(CUrl_Result*)clientp};
-    
-    auto ptr {(char*)realloc(mem->response, mem->size + real_size + 1)};
-    if(ptr == NULL){
-      return 0;
+    auto& result {*(CUrl_Result*)clientp};
+
+    if(!result.sized)
+    {
+        result.sized = true;
+        // a lying header shouldn't be able to make us grab gigabytes up front
+        constexpr curl_off_t max_reserve {64 * 1024 * 1024};
+        curl_off_t length {-1};
+        if(curl_easy_getinfo(result.handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length) == CURLE_OK && length > 0 && length <= max_reserve){
+            result.body->reserve(result.body->size() + (size_t)length);
+        }
     }
-    
-    mem->response = ptr;
-    memcpy(&(mem->response[mem->size]), data, real_size);
-    mem->size += real_size;
-    mem->response[mem->size] = 0;
-    
+
+    result.body->append((const char*)data, real_size);
     return real_size;
 }
- 
+
+// out is cleared but keeps its capacity, so calling in a loop with the same string stops allocating once it's big enough
+inline bool curl_call(const String& s, CURL* handle, curl_slist* list, String* out)
+{
+    out->clear();
+    if(!handle){
+        return false;
+    }
+    CUrl_Result result {out, handle};
+    curl_easy_setopt(handle, CURLOPT_URL, s.c_str());
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, curl_callback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, (void*)&result);
+    if(list){
+        curl_easy_setopt(handle, CURLOPT_HTTPHEADER, list);
+    }
+    const auto ok {curl_easy_perform(handle) == CURLE_OK};
+
+    long connects {0};
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+    curl_stats.transfers++;
+    if(connects > 0)
+    {
+        curl_off_t handshake {0};
+        curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &handshake);
+        if(handshake == 0){
+            curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &handshake);
+        }
+        curl_stats.new_connections += connects;
+        curl_stats.handshake_us += handshake;
+    }
+    return ok;
+}
+
 inline String curl_call(const String& s, CURL* handle, curl_slist* list = nullptr)
 {
-    CUrl_Result chunk {0};
-    CURLcode res;
-    if(handle)
+    String body;
+    curl_call(s, handle, list, &body);
+    return body;
+}
+
+// easy handles are handed out to whoever needs one so any number of calls can be in flight at once.
+// a handle that comes back keeps its open connections, the next call to that host on it skips the handshake.
+// every handle shares one dns cache and tls session cache, so even a fresh connection skips the lookup and resumes
+// the session. the connection cache itself isn't shared, libcurl doesn't support that across threads
+struct Curl_Pool
+{
+    // gives the handle back when it goes out of scope
+    struct Lease
+    {
+        Lease(Curl_Pool* p) : pool {p}, handle {p->take()}
+        {
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ~Lease()
+        {
+            pool->give_back(handle);
+        }
+
+        operator CURL*() const
+        {
+            return handle;
+        }
+
+        private:
+            Curl_Pool* pool;
+            CURL* handle;
+    };
+
+    // the handle comes reset, options from the last user are gone but its connections aren't
+    Lease acquire()
     {
-        auto deez {curl_easy_setopt(handle, CURLOPT_URL, s.c_str())};
+        return Lease{this};
+    }
 
-        deez = curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, curl_callback);
-     
-        deez = curl_easy_setopt(handle, CURLOPT_WRITEDATA, (void *)&chunk);
-     
-        if(list){
-            curl_easy_setopt(handle, CURLOPT_HTTPHEADER, list);
+    // call before curl_global_cleanup with nothing leased
+    void clear()
+    {
+        std::scoped_lock l {mutex};
+        for(auto h : idle){
+            curl_easy_cleanup(h);
         }
+        idle.clear();
+        if(share)
+        {
+            curl_share_cleanup(share);
+            share = nullptr;
+        }
+    }
 
-        res = curl_easy_perform(handle);
+    ~Curl_Pool()
+    {
+        clear();
     }
-    String str {chunk.response, chunk.response + chunk.size}; 
-    free(chunk.response);
-    return str;
-}
 
+    private:
+        CURL* take()
+        {
+            CURL* h {nullptr};
+            {
+                std::scoped_lock l {mutex};
+                if(!share){
+                    create_share();
+                }
+                if(!idle.empty())
+                {
+                    h = idle.back();
+                    idle.pop_back();
+                }
+            }
+            if(h){
+                curl_easy_reset(h);
+            }
+            else{
+                h = curl_easy_init();
+            }
+            curl_easy_setopt(h, CURLOPT_SHARE, share);
+            return h;
+        }
+
+        // made on first use so it comes after curl_global_init even though the pool is a global
+        void create_share()
+        {
+            share = curl_share_init();
+            curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lock_share);
+            curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlock_share);
+            curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
+
+        static void lock_share(CURL*, curl_lock_data data, curl_lock_access, void* pool)
+        {
+            ((Curl_Pool*)pool)->share_mutexes[data].lock();
+        }
 
+        static void unlock_share(CURL*, curl_lock_data data, void* pool)
+        {
+            ((Curl_Pool*)pool)->share_mutexes[data].unlock();
+        }
+
+        void give_back(CURL* h)
+        {
+            std::scoped_lock l {mutex};
+            idle.push_back(h);
+        }
+
+        std::mutex mutex;
+        Vector<CURL*> idle;
+        CURLSH* share {nullptr};
+        std::mutex share_mutexes[CURL_LOCK_DATA_LAST];
+};
@@ -0,0 +1,321 @@
+#pragma once
+
+#include "types.hpp"
+#include "curl_wrapper.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <ctime>
+#include <cctype>
+#include <cstdio>
+
+// every helix call goes through here. twitch gives each token a bucket of points that refills every minute and
+// reports what's left in Ratelimit-Remaining and when it's full again in Ratelimit-Reset, the client spends from
+// its own copy of that bucket and waits for the reset once it's empty instead of sending requests to be rejected.
+// queued requests go out by priority so bans don't wait behind follower pages, a 429 puts the request
+// back at the front of its priority and everyone backs off
+struct Helix_Client
+{
+    enum Priority
+    {
+        Moderation,
+        Normal,
+        Bulk,
+    };
+
+    struct Request
+    {
+        Priority priority {Normal};
+        String method {"GET"};
+        String url;
+        String body;
+    };
+
+    struct Response
+    {
+        // 0 when no response came back at all
+        long status {0};
+        String body;
+    };
+
+    Helix_Client(Curl_Pool* p, const int thread_count) : pool {p}
+    {
+        for(int i = 0; i < thread_count; i++){
+            threads.push_back(std::thread(&Helix_Client::work, this));
+        }
+    }
+
+    ~Helix_Client()
+    {
+        {
+            std::scoped_lock l {mutex};
+            stopping = true;
+        }
+        condition_variable.notify_all();
+        for(auto& t : threads){
+            t.join();
+        }
+    }
+
+    // before the first request
+    void set_credentials(const String& id, const String& token)
+    {
+        client_id = id;
+        auth_token = token;
+    }
+
+    using Completion = std::function<void(Response)>;
+
+    // done runs on a helix thread with the final answer so nobody has to wait for it, keep it short
+    void submit(Request request, Completion done)
+    {
+        Item item;
+        item.request = std::move(request);
+        item.done = std::move(done);
+        {
+            std::scoped_lock l {mutex};
+            item.sequence = next_sequence++;
+            queue.push(std::move(item));
+        }
+        condition_variable.notify_one();
+    }
+
+    std::future<Response> submit(Request request)
+    {
+        auto result {std::make_shared<std::promise<Response>>()};
+        auto future {result->get_future()};
+        submit(std::move(request), [result](Response response){
+            result->set_value(std::move(response));
+        });
+        return future;
+    }
+
+    Response call(Request request)
+    {
+        return submit(std::move(request)).get();
+    }
+
+    size_t queue_depth()
+    {
+        std::scoped_lock l {mutex};
+        return queue.size();
+    }
+
+    private:
+        static constexpr int max_attempts {8};
+
+        struct Item
+        {
+            Request request;
+            u64 sequence {0};
+            int attempts {0};
+            Completion done;
+        };
+
+        struct Later
+        {
+            bool operator()(const Item& a, const Item& b) const
+            {
+                if(a.request.priority != b.request.priority){
+                    return a.request.priority > b.request.priority;
+                }
+                return a.sequence > b.sequence;
+            }
+        };
+
+        struct Rate_Headers
+        {
+            long limit     {-1};
+            long remaining {-1};
+            s64 reset      {-1};
+        };
+
+        static size_t read_header(char* data, size_t size, size_t count, void* user)
+        {
+            const auto length {size * count};
+            auto& headers {*(Rate_Headers*)user};
+            String_View line {data, length};
+            const auto colon {line.find(':')};
+            if(colon == String_View::npos){
+                return length;
+            }
+
+            auto name {line.substr(0, colon)};
+            auto value {line.substr(colon + 1)};
+            auto equals {[&name](const String_View s)
+            {
+                if(name.size() != s.size()){
+                    return false;
+                }
+                for(size_t i = 0; i < s.size(); i++)
+                {
+                    if(tolower((u8)name[i]) != s[i]){
+                        return false;
+                    }
+                }
+                return true;
+            }};
+            auto number {[&value]()
+            {
+                s64 result {0};
+                bool any {false};
+                for(const auto c : value)
+                {
+                    if(c >= '0' && c <= '9')
+                    {
+                        result = result * 10 + (c - '0');
+                        any = true;
+                    }
+                    else if(any){
+                        break;
+                    }
+                }
+                return any ? result : (s64)-1;
+            }};
+
+            if(equals("ratelimit-limit")){
+                headers.limit = (long)number();
+            }
+            else if(equals("ratelimit-remaining")){
+                headers.remaining = (long)number();
+            }
+            else if(equals("ratelimit-reset")){
+                headers.reset = number();
+            }
+            return length;
+        }
+
+        static Stamp from_unix_time(const s64 seconds)
+        {
+            const auto from_now {seconds - (s64)std::time(nullptr)};
+            return Clock::now() + std::chrono::seconds{from_now > 0 ? from_now : 0};
+        }
+
+        // caller holds mutex, true when a request can go out now
+        bool take_token(const Stamp now)
+        {
+            if(now < paused_until){
+                return false;
+            }
+            if(remaining < 0){
+                return true;
+            }
+            if(remaining == 0 && now >= reset_at){
+                remaining = limit > 0 ? limit : -1;
+            }
+            if(remaining == 0){
+                return false;
+            }
+            if(remaining > 0){
+                remaining--;
+            }
+            return true;
+        }
+
+        Response perform(const Request& request, Rate_Headers* headers)
+        {
+            Response response;
+            auto handle {pool->acquire()};
+            auto list {set_curl_headers(("Authorization: Bearer " + auth_token).c_str(),
+                                        ("Client-Id: " + client_id).c_str(),
+                                        "Content-Type: application/json")};
+            curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, read_header);
+            curl_easy_setopt(handle, CURLOPT_HEADERDATA, (void*)headers);
+            if(request.method != "GET"){
+                curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+            }
+            if(!request.body.empty()){
+                curl_easy_setopt(handle, CURLOPT_POSTFIELDS, request.body.c_str());
+            }
+            if(curl_call(request.url, handle, list, &response.body)){
+                curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response.status);
+            }
+            curl_slist_free_all(list);
+            return response;
+        }
+
+        void work()
+        {
+            std::unique_lock l {mutex};
+            while(true)
+            {
+                const auto now {Clock::now()};
+                if(stopping){
+                    return;
+                }
+                if(queue.empty())
+                {
+                    condition_variable.wait(l);
+                    continue;
+                }
+                if(!take_token(now))
+                {
+                    condition_variable.wait_until(l, std::max(paused_until, reset_at));
+                    continue;
+                }
+
+                auto item {std::move(const_cast<Item&>(queue.top()))};
+                queue.pop();
+                l.unlock();
+
+                Rate_Headers headers;
+                auto response {perform(item.request, &headers)};
+                item.attempts++;
+
+                l.lock();
+                if(headers.limit > 0){
+                    limit = headers.limit;
+                }
+                if(headers.remaining >= 0){
+                    remaining = headers.remaining;
+                }
+                if(headers.reset >= 0){
+                    reset_at = from_unix_time(headers.reset);
+                }
+
+                if(response.status == 429 && item.attempts < max_attempts)
+                {
+                    // without a reset header nothing says when to try again, so back off doubling from a second
+                    if(headers.reset < 0){
+                        paused_until = Clock::now() + std::chrono::seconds{1 << (item.attempts - 1)};
+                    }
+                    else
+                    {
+                        remaining = 0;
+                        paused_until = reset_at;
+                    }
+                    queue.push(std::move(item));
+                    continue;
+                }
+                if(response.status == 429){
+                    printf("helix gave up on %s %s after %i tries\n", item.request.method.c_str(), item.request.url.c_str(), item.attempts);
+                }
+
+                l.unlock();
+                item.done(std::move(response));
+                l.lock();
+            }
+        }
+
+        Curl_Pool* pool;
+        String client_id;
+        String auth_token;
+
+        std::mutex mutex;
+        std::condition_variable condition_variable;
+        std::priority_queue<Item, Vector<Item>, Later> queue;
+        u64 next_sequence {0};
+        bool stopping {false};
+
+        // the bucket as twitch last reported it, -1 until the first response says
+        long limit {-1};
+        long remaining {-1};
+        Stamp reset_at {};
+        Stamp paused_until {};
+
+        Vector<std::thread> threads;
+};
@@ -0,0 +1,330 @@
+#pragma once
+
+#include "types.hpp"
+#include "utilities.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IRC_SSE2
+#endif
+
+// IRCv3 line, every view points into the buffer that was parsed so keep that alive.
+// tag values are left escaped (\s \: etc), none of the tags the bot reads use them
+struct Irc_Tag
+{
+    String_View key;
+    String_View value;
+};
+
+struct Irc_Message
+{
+    // a shared chat reply carries a bit over 30, anything past this goes to spill_tags so no tag is ever dropped
+    static constexpr int max_tags {64};
+
+    Irc_Tag tags[max_tags];
+    int tag_count {0};
+    // keeps its capacity when the message is parsed into again
+    Vector<Irc_Tag> spill_tags;
+
+    String_View prefix;
+    String_View nick;
+    String_View command;
+    String_View params;
+    String_View trailing;
+
+    const Irc_Tag* find_tag(const String_View key) const
+    {
+        for(int i = 0; i < tag_count; i++)
+        {
+            if(tags[i].key == key){
+                return &tags[i];
+            }
+        }
+        for(const auto& t : spill_tags)
+        {
+            if(t.key == key){
+                return &t;
+            }
+        }
+        return nullptr;
+    }
+
+    bool has_tag(const String_View key) const
+    {
+        return find_tag(key) != nullptr;
+    }
+
+    String_View get_tag(const String_View key) const
+    {
+        auto t {find_tag(key)};
+        return t ? t->value : String_View{};
+    }
+
+    void clear()
+    {
+        tag_count = 0;
+        spill_tags.clear();
+        prefix = {};
+        nick = {};
+        command = {};
+        params = {};
+        trailing = {};
+    }
+};
+
+using Badges = u32;
+
+enum Badge : Badges
+{
+    broadcaster_badge = 1 << 0,
+    moderator_badge   = 1 << 1,
+    vip_badge         = 1 << 2,
+    founder_badge     = 1 << 3,
+    subscriber_badge  = 1 << 4,
+    staff_badge       = 1 << 5,
+    partner_badge     = 1 << 6,
+    turbo_badge       = 1 << 7,
+    prime_badge       = 1 << 8,
+    artist_badge      = 1 << 9,
+    // anything twitch adds that we don't know about, still counts as having a badge
+    other_badge       = 1u << 31,
+};
+
+constexpr Pair<String_View, Badge> badge_names[] {{"broadcaster", broadcaster_badge},
+                                                  {"moderator", moderator_badge},
+                                                  {"vip", vip_badge},
+                                                  {"founder", founder_badge},
+                                                  {"subscriber", subscriber_badge},
+                                                  {"staff", staff_badge},
+                                                  {"partner", partner_badge},
+                                                  {"turbo", turbo_badge},
+                                                  {"premium", prime_badge},
+                                                  {"artist-badge", artist_badge}};
+
+// badges tag looks like broadcaster/1,subscriber/12
+inline Badges parse_badges(String_View s)
+{
+    Badges result {0};
+    while(!s.empty())
+    {
+        auto comma {s.find(',')};
+        auto badge {s.substr(0, comma)};
+        s.remove_prefix(comma == String_View::npos ? s.size() : comma + 1);
+
+        badge = badge.substr(0, badge.find('/'));
+        if(badge.empty()){
+            continue;
+        }
+        auto bit {(Badges)other_badge};
+        for(const auto& b : badge_names)
+        {
+            if(b.first == badge)
+            {
+                bit = b.second;
+                break;
+            }
+        }
+        result |= bit;
+    }
+    return result;
+}
+
+struct Irc_Block
+{
+    // one bit per byte of a 64 byte block
+    u64 semi_colon;
+    u64 equals;
+    u64 space;
+};
+
+// where the ; = and spaces are in 64 bytes of a tag section
+inline Irc_Block irc_classify(const char* p)
+{
+    Irc_Block b {0, 0, 0};
+#ifdef IRC_SSE2
+    const auto semi_colons {_mm_set1_epi8(';')};
+    const auto equal_signs {_mm_set1_epi8('=')};
+    const auto spaces {_mm_set1_epi8(' ')};
+    for(int i = 0; i < 4; i++)
+    {
+        const auto chunk {_mm_loadu_si128((const __m128i*)(p + i * 16))};
+        b.semi_colon |= (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, semi_colons)) << (i * 16);
+        b.equals     |= (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, equal_signs)) << (i * 16);
+        b.space      |= (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, spaces)) << (i * 16);
+    }
+#else
+    for(int i = 0; i < 64; i++)
+    {
+        const auto c {p[i]};
+        const auto m {(u64)1 << i};
+        b.semi_colon |= c == ';' ? m : 0;
+        b.equals     |= c == '=' ? m : 0;
+        b.space      |= c == ' ' ? m : 0;
+    }
+#endif
+    return b;
+}
+
+// pops the next line off a websocket frame, twitch can pack several into one frame
+inline String_View irc_next_line(String_View* frame)
+{
+    auto& f {*frame};
+    auto end {f.find('\n')};
+    String_View line;
+    if(end == String_View::npos)
+    {
+        line = f;
+        f = {};
+    }
+    else
+    {
+        line = f.substr(0, end);
+        f.remove_prefix(end + 1);
+    }
+    if(!line.empty() && line.back() == '\r'){
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+// single pass, no allocations unless a line has more than max_tags tags. returns false if there's no command
+inline bool parse_irc_message(String_View line, Irc_Message* out)
+{
+    auto& result {*out};
+    result.clear();
+
+    auto next_word {[&line]()
+    {
+        auto space {line.find(' ')};
+        String_View word {line.substr(0, space)};
+        line.remove_prefix(space == String_View::npos ? line.size() : space + 1);
+        while(!line.empty() && line.front() == ' '){
+            line.remove_prefix(1);
+        }
+        return word;
+    }};
+
+    if(!line.empty() && line.front() == '@')
+    {
+        line.remove_prefix(1);
+        // the tags are most of a chat line, so instead of a find for every ; and = this classifies 64 bytes at a
+        // time and steps from ; to ;. the first = in a tag splits key from value and comes out of the bitmask
+        size_t tag_start {0};
+        // first = of a tag that started in an earlier block
+        size_t carried_equals {String_View::npos};
+        size_t end {String_View::npos};
+
+        char tail[64];
+        for(size_t base = 0; end == String_View::npos; base += 64)
+        {
+            const char* p {line.data() + base};
+            // the space padding ends the tags if the line does
+            if(line.size() - base < 64)
+            {
+                memset(tail, ' ', sizeof(tail));
+                memcpy(tail, p, line.size() - base);
+                p = tail;
+            }
+            auto b {irc_classify(p)};
+            if(b.space)
+            {
+                // the first space ends the last tag like a ; would, nothing after it is a tag
+                const auto space {b.space & (~b.space + 1)};
+                b.semi_colon = (b.semi_colon & (space - 1)) | space;
+                end = base + trailing_zeros(space);
+            }
+            while(b.semi_colon)
+            {
+                const auto i {base + trailing_zeros(b.semi_colon)};
+                b.semi_colon &= b.semi_colon - 1;
+                const auto from {tag_start > base ? tag_start - base : 0};
+                const auto in_tag {b.equals & (~(u64)0 << from) & (((u64)1 << (i - base)) - 1)};
+                auto equals {carried_equals};
+                if(equals == String_View::npos && in_tag){
+                    equals = base + trailing_zeros(in_tag);
+                }
+                if(i > tag_start)
+                {
+                    Irc_Tag t;
+                    if(equals == String_View::npos){
+                        t.key = String_View{line.data() + tag_start, i - tag_start};
+                    }
+                    else
+                    {
+                        t.key = String_View{line.data() + tag_start, equals - tag_start};
+                        t.value = String_View{line.data() + equals + 1, i - equals - 1};
+                    }
+                    if(result.tag_count < Irc_Message::max_tags){
+                        result.tags[result.tag_count++] = t;
+                    }
+                    else{
+                        result.spill_tags.push_back(t);
+                    }
+                }
+                tag_start = i + 1;
+                carried_equals = String_View::npos;
+            }
+            // the tag still going into the next block
+            if(carried_equals == String_View::npos && tag_start < base + 64)
+            {
+                const auto rest {b.equals & (~(u64)0 << (tag_start > base ? tag_start - base : 0))};
+                if(rest){
+                    carried_equals = base + trailing_zeros(rest);
+                }
+            }
+        }
+        end = std::min(end, line.size());
+
+        line.remove_prefix(end == line.size() ? end : end + 1);
+        while(!line.empty() && line.front() == ' '){
+            line.remove_prefix(1);
+        }
+    }
+
+    if(!line.empty() && line.front() == ':')
+    {
+        line.remove_prefix(1);
+        result.prefix = next_word();
+        result.nick = result.prefix.substr(0, result.prefix.find('!'));
+    }
+
+    result.command = next_word();
+    if(result.command.empty()){
+        return false;
+    }
+
+    auto trailing {line.find(" :")};
+    if(!line.empty() && line.front() == ':'){
+        trailing = 0;
+    }
+    else if(trailing != String_View::npos){
+        trailing++;
+    }
+
+    if(trailing == String_View::npos){
+        result.params = line;
+    }
+    else
+    {
+        result.params = line.substr(0, trailing);
+        result.trailing = line.substr(trailing + 1);
+    }
+
+    auto is_white_space {[](const char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }};
+    while(!result.params.empty() && is_white_space(result.params.back())){
+        result.params.remove_suffix(1);
+    }
+    while(!result.trailing.empty() && is_white_space(result.trailing.front())){
+        result.trailing.remove_prefix(1);
+    }
+    while(!result.trailing.empty() && is_white_space(result.trailing.back())){
+        result.trailing.remove_suffix(1);
+    }
+
+    return true;
+}
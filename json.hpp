@@ -1,56 +1,713 @@
 #pragma once
 #include "types.hpp"
+#include "utilities.hpp"
+#include <initializer_list>
+#include <algorithm>
+#include <cstring>
+#include <charconv>
 
-inline String json_get_value_naive(const String& key, const String& data)
-{   
-    size_t colon {0};
-    size_t quote {0};
-    size_t quote_2 {0};
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_SSE2
+#endif
 
-    auto get_valid_colon_helper {[&]()
+enum class Json_Type : u8
+{
+    None,
+    String,
+    Number,
+    True,
+    False,
+    Null,
+    Object,
+    Array,
+};
+
+// a value found by json_read, text points into the data that was read so keep that alive.
+// strings are the raw text between the quotes, objects and arrays the whole thing brackets included
+struct Json_Value
+{
+    Json_Type type {Json_Type::None};
+    String_View text;
+    // the string has escapes in it, view() is only the decoded string when this is false
+    bool escaped {false};
+
+    bool found() const
+    {
+        return type != Json_Type::None;
+    }
+
+    String_View view() const
+    {
+        return text;
+    }
+
+    // appends the decoded string, \uXXXX escapes come out as utf-8
+    void decode(String* out) const;
+
+    String string() const
+    {
+        if(!escaped){
+            return String{text};
+        }
+        String result;
+        decode(&result);
+        return result;
+    }
+};
+
+// path is the keys from the top separated by dots like payload.event.user_id, array elements are numbered from 0
+// like items.0.id. out is cleared and filled if it's there. keys are compared as they are written
+struct Json_Path
+{
+    String_View path;
+    Json_Value* out;
+};
+
+inline void Json_Value::decode(String* out) const
+{
+    auto hex {[this](const size_t at)
+    {
+        u32 result {0};
+        for(size_t i = at; i < at + 4; i++)
+        {
+            if(i >= text.size()){
+                return (u32)-1;
+            }
+            const auto c {text[i]};
+            result <<= 4;
+            if(c >= '0' && c <= '9'){
+                result |= c - '0';
+            }
+            else if(c >= 'a' && c <= 'f'){
+                result |= c - 'a' + 10;
+            }
+            else if(c >= 'A' && c <= 'F'){
+                result |= c - 'A' + 10;
+            }
+            else{
+                return (u32)-1;
+            }
+        }
+        return result;
+    }};
+
+    auto utf8 {[out](const u32 c)
+    {
+        if(c < 0x80){
+            out->push_back((char)c);
+        }
+        else if(c < 0x800)
+        {
+            out->push_back((char)(0xc0 | (c >> 6)));
+            out->push_back((char)(0x80 | (c & 0x3f)));
+        }
+        else if(c < 0x10000)
+        {
+            out->push_back((char)(0xe0 | (c >> 12)));
+            out->push_back((char)(0x80 | ((c >> 6) & 0x3f)));
+            out->push_back((char)(0x80 | (c & 0x3f)));
+        }
+        else
+        {
+            out->push_back((char)(0xf0 | (c >> 18)));
+            out->push_back((char)(0x80 | ((c >> 12) & 0x3f)));
+            out->push_back((char)(0x80 | ((c >> 6) & 0x3f)));
+            out->push_back((char)(0x80 | (c & 0x3f)));
+        }
+    }};
+
+    out->reserve(out->size() + text.size());
+    size_t i {0};
+    while(i < text.size())
     {
-        colon = data.find(':', colon + 1);
-        quote = data.find('"', quote_2 + 1);
-        quote_2 = data.find('"', quote + 1);
-        while(colon > quote && colon < quote_2)
+        const auto escape {text.find('\\', i)};
+        out->append(text.substr(i, escape - i));
+        if(escape == String_View::npos || escape + 1 >= text.size()){
+            return;
+        }
+        i = escape + 2;
+        switch(text[escape + 1])
         {
-            colon = data.find(':', quote_2);
-            quote = data.find('"', quote_2 + 1);
-            quote_2 = data.find('"', quote + 1);
-            if(colon == String::npos){
+            case 'b': out->push_back('\b'); break;
+            case 'f': out->push_back('\f'); break;
+            case 'n': out->push_back('\n'); break;
+            case 'r': out->push_back('\r'); break;
+            case 't': out->push_back('\t'); break;
+            case 'u':
+            {
+                auto c {hex(i)};
+                if(c == (u32)-1){
+                    return;
+                }
+                i += 4;
+                // characters past the first plane come as a surrogate pair
+                if(c >= 0xd800 && c < 0xdc00 && i + 1 < text.size() && text[i] == '\\' && text[i + 1] == 'u')
+                {
+                    const auto low {hex(i + 2)};
+                    if(low >= 0xdc00 && low < 0xe000)
+                    {
+                        c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+                        i += 6;
+                    }
+                }
+                utf8(c);
                 break;
             }
+            default: out->push_back(text[escape + 1]); break;
+        }
+    }
+}
+
+// bit i of each mask is byte i of a 64 byte block
+struct Json_Block
+{
+    u64 quote;
+    u64 backslash;
+    // { } [ ] : ,
+    u64 structural;
+    u64 white_space;
+};
+
+inline Json_Block json_classify(const char* p)
+{
+    Json_Block b;
+#if defined(__AVX2__)
+    const auto lo {_mm256_loadu_si256((const __m256i*)p)};
+    const auto hi {_mm256_loadu_si256((const __m256i*)(p + 32))};
+    // { and [ differ only in the 0x20 bit, so do } and ]
+    const auto bit {_mm256_set1_epi8(0x20)};
+    const auto lo_lowered {_mm256_or_si256(lo, bit)};
+    const auto hi_lowered {_mm256_or_si256(hi, bit)};
+    auto masks {[](const __m256i& l, const __m256i& h, const char c)
+    {
+        const auto v {_mm256_set1_epi8(c)};
+        return (u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, v)) |
+               ((u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(h, v)) << 32);
+    }};
+    b.quote       = masks(lo, hi, '"');
+    b.backslash   = masks(lo, hi, '\\');
+    b.structural  = masks(lo_lowered, hi_lowered, '{') | masks(lo_lowered, hi_lowered, '}') | masks(lo, hi, ':') | masks(lo, hi, ',');
+    b.white_space = masks(lo, hi, ' ') | masks(lo, hi, '\t') | masks(lo, hi, '\r') | masks(lo, hi, '\n');
+#elif defined(JSON_SSE2)
+    __m128i chunks[4];
+    __m128i lowered[4];
+    const auto bit {_mm_set1_epi8(0x20)};
+    for(int i = 0; i < 4; i++)
+    {
+        chunks[i] = _mm_loadu_si128((const __m128i*)(p + i * 16));
+        // { and [ differ only in the 0x20 bit, so do } and ]
+        lowered[i] = _mm_or_si128(chunks[i], bit);
+    }
+    auto masks {[](const __m128i* from, const char c)
+    {
+        const auto v {_mm_set1_epi8(c)};
+        u64 result {0};
+        for(int i = 0; i < 4; i++){
+            result |= (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(from[i], v)) << (i * 16);
+        }
+        return result;
+    }};
+    b.quote       = masks(chunks, '"');
+    b.backslash   = masks(chunks, '\\');
+    b.structural  = masks(lowered, '{') | masks(lowered, '}') | masks(chunks, ':') | masks(chunks, ',');
+    b.white_space = masks(chunks, ' ') | masks(chunks, '\t') | masks(chunks, '\r') | masks(chunks, '\n');
+#else
+    b = {};
+    for(int i = 0; i < 64; i++)
+    {
+        const auto c {p[i]};
+        const auto m {(u64)1 << i};
+        b.quote       |= c == '"' ? m : 0;
+        b.backslash   |= c == '\\' ? m : 0;
+        b.structural  |= (c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',') ? m : 0;
+        b.white_space |= (c == ' ' || c == '\t' || c == '\r' || c == '\n') ? m : 0;
+    }
+#endif
+    return b;
+}
+
+// where every { } [ ] : , and quote outside of strings is, and where every other value starts.
+// the input is looked at 64 bytes at a time as bitmasks so nothing has to branch on each byte, strings come
+// out as the opening and closing quote next to each other. false if the data ends inside a string
+inline bool json_index(const String_View data, Vector<u32>* out)
+{
+    auto& index {*out};
+    index.clear();
+
+    // carried between blocks, all ones or all zeros for in_string
+    u64 prev_escaped {0};
+    u64 prev_in_string {0};
+    u64 prev_scalar {0};
+
+    char tail[64];
+    for(size_t base = 0; base < data.size(); base += 64)
+    {
+        const char* p {data.data() + base};
+        if(data.size() - base < 64)
+        {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, p, data.size() - base);
+            p = tail;
+        }
+        auto b {json_classify(p)};
+
+        // a character is escaped when it's after an odd run of backslashes. runs starting on an odd bit are
+        // added to themselves so the carry clears them, what's left says which runs start on even bits
+        const u64 even_bits {0x5555555555555555ull};
+        const auto backslash {b.backslash & ~prev_escaped};
+        const auto follows_escape {backslash << 1 | prev_escaped};
+        const auto odd_starts {backslash & ~even_bits & ~follows_escape};
+        const auto even_starts {odd_starts + backslash};
+        prev_escaped = even_starts < odd_starts;
+        const auto escaped {(even_bits ^ (even_starts << 1)) & follows_escape};
+
+        const auto quote {b.quote & ~escaped};
+        // bits from each opening quote up to the closing one
+        auto in_string {quote};
+        in_string ^= in_string << 1;
+        in_string ^= in_string << 2;
+        in_string ^= in_string << 4;
+        in_string ^= in_string << 8;
+        in_string ^= in_string << 16;
+        in_string ^= in_string << 32;
+        in_string ^= prev_in_string;
+        prev_in_string = (u64)((s64)in_string >> 63);
+
+        const auto structural {b.structural & ~in_string};
+        const auto scalar {~(b.structural | b.white_space | quote | in_string)};
+        const auto scalar_start {scalar & ~(scalar << 1 | prev_scalar)};
+        prev_scalar = scalar >> 63;
+
+        auto bits {structural | quote | scalar_start};
+        if(data.size() - base < 64){
+            bits &= ((u64)1 << (data.size() - base)) - 1;
+        }
+        while(bits)
+        {
+            index.push_back((u32)(base + trailing_zeros(bits)));
+            bits &= bits - 1;
+        }
+    }
+    return prev_in_string == 0;
+}
+
+// indexes data and walks the index once from the front filling in every path it comes across. when array_path is
+// given, element_paths are read relative to each object in that array, like user_id for data.0.user_id, and each()
+// is called after every one of them with its paths filled in, returning false stops the walk there.
+// it stops as soon as all paths are found and the array is done. false if data ends in the middle of something
+template<typename Each>
+inline bool json_walk(const String_View data, const Json_Path* paths, const size_t path_count,
+                      const String_View array_path, const Json_Path* element_paths, const size_t element_path_count, Each& each)
+{
+    constexpr int max_depth {64};
+    struct Frame
+    {
+        // where this object or array is in its parent, by key or by element for arrays
+        String_View key;
+        u32 element;
+        size_t begin;
+        // which path this is, element paths come after the others
+        int path;
+        bool array;
+        // for arrays the element being read
+        u32 count;
+    };
+    Frame frames[max_depth];
+    int depth {0};
+
+    size_t left {path_count};
+    for(size_t p = 0; p < path_count; p++){
+        *paths[p].out = {};
+    }
+    // frame of the array being gone through, -1 before and after it
+    int array_at {-1};
+    auto array_done {array_path.empty()};
+    if(left == 0 && array_done){
+        return true;
+    }
+
+    String_View key;
+    bool expect_key {false};
+
+    // takes the next segment off the front of rest if it names key, or element when the parent is an array
+    auto take_segment {[](String_View* rest, const bool last, const bool in_array, const String_View key, const u32 element)
+    {
+        auto& r {*rest};
+        const auto length {last ? r.size() : r.find('.')};
+        if(length == String_View::npos){
+            return false;
+        }
+        const auto segment {r.substr(0, length)};
+        if(in_array)
+        {
+            u32 n;
+            const auto result {std::from_chars(segment.data(), segment.data() + segment.size(), n)};
+            if(segment.empty() || result.ec != std::errc{} || result.ptr != segment.data() + segment.size() || n != element){
+                return false;
+            }
         }
+        else if(segment != key){
+            return false;
+        }
+        r.remove_prefix(last ? length : length + 1);
+        return true;
     }};
 
-    auto get_value {[&]()
+    // whether the value about to be read is at path, counting segments from frame first
+    auto matches {[&](String_View path, const int first)
     {
-        String result;
-        while(true)
+        const auto& top {frames[depth - 1]};
+        for(int d = first; d < depth; d++)
+        {
+            if(!take_segment(&path, false, frames[d - 1].array, frames[d].key, frames[d].element)){
+                return false;
+            }
+        }
+        return take_segment(&path, true, top.array, key, top.count);
+    }};
+
+    // how many segments each path has and its last one, so a value at another depth or under another key is
+    // turned down without going through the frames. element paths come after the others
+    struct Shape
+    {
+        int segments;
+        String_View last;
+    };
+    thread_local Vector<Shape> shapes;
+    shapes.clear();
+    auto add_shape {[](const String_View path)
+    {
+        const auto dot {path.rfind('.')};
+        shapes.push_back({(int)std::count(path.begin(), path.end(), '.') + 1, dot == String_View::npos ? path : path.substr(dot + 1)});
+    }};
+    for(size_t p = 0; p < path_count; p++){
+        add_shape(paths[p].path);
+    }
+    for(size_t p = 0; p < element_path_count; p++){
+        add_shape(element_paths[p].path);
+    }
+
+    auto find_path {[&]()
+    {
+        if(depth == 0){
+            return -1;
+        }
+        const auto in_array {frames[depth - 1].array};
+        auto could_match {[&](const Shape& shape, const int first)
+        {
+            return shape.segments == depth - first + 1 && (in_array || shape.last == key);
+        }};
+        for(size_t p = 0; p < path_count; p++)
+        {
+            if(!paths[p].out->found() && could_match(shapes[p], 1) && matches(paths[p].path, 1)){
+                return (int)p;
+            }
+        }
+        // inside an element of the array
+        if(array_at >= 0 && depth >= array_at + 2)
         {
-            get_valid_colon_helper();
-            int quote_counter {0};
-            if(colon != String::npos)
+            for(size_t p = 0; p < element_path_count; p++)
             {
-                auto q {data.rfind('"', colon - 1)};
-                auto q2 {data.rfind('"', q - 1)};
-                auto k {data.substr(q2 + 1, (q - q2) - 1)};
-                if(k == key)
+                if(!element_paths[p].out->found() && could_match(shapes[path_count + p], array_at + 2) &&
+                   matches(element_paths[p].path, array_at + 2)){
+                    return (int)(path_count + p);
+                }
+            }
+        }
+        return -1;
+    }};
+
+    auto found {[&](const int p, const Json_Value& v)
+    {
+        if((size_t)p < path_count)
+        {
+            *paths[p].out = v;
+            left--;
+        }
+        else{
+            *element_paths[p - path_count].out = v;
+        }
+    }};
+
+    // kept per thread so reading doesn't allocate once it has grown to the biggest payload
+    thread_local Vector<u32> index;
+    if(!json_index(data, &index)){
+        return false;
+    }
+
+    const auto n {index.size()};
+    for(size_t k = 0; k < n; k++)
+    {
+        const size_t i {index[k]};
+        const auto c {data[i]};
+        switch(c)
+        {
+            case '{': case '[':
+            {
+                if(depth == max_depth){
+                    return false;
+                }
+                const auto array {c == '['};
+                if(array_at >= 0 && depth == array_at + 1)
+                {
+                    for(size_t p = 0; p < element_path_count; p++){
+                        *element_paths[p].out = {};
+                    }
+                }
+                else if(array && !array_done && array_at < 0 && depth > 0 && matches(array_path, 1)){
+                    array_at = depth;
+                }
+                const auto element {depth > 0 ? frames[depth - 1].count : 0};
+                frames[depth] = {key, element, i, find_path(), array, 0};
+                depth++;
+                key = {};
+                expect_key = !array;
+                break;
+            }
+            case '}': case ']':
+            {
+                if(depth == 0){
+                    return false;
+                }
+                depth--;
+                const auto& f {frames[depth]};
+                if(f.path >= 0){
+                    found(f.path, {f.array ? Json_Type::Array : Json_Type::Object, data.substr(f.begin, i - f.begin + 1)});
+                }
+                if(array_at >= 0 && depth == array_at + 1 && !f.array && !each()){
+                    return true;
+                }
+                if(depth == array_at)
                 {
-                    q = data.find('"', colon);
-                    q2 = data.find('"', q + 1);
-                    result = data.substr(q + 1, (q2 - q) - 1);
+                    array_at = -1;
+                    array_done = true;
+                }
+                if((left == 0 && array_done) || depth == 0){
+                    return true;
+                }
+                expect_key = false;
+                break;
+            }
+            case ':':
+            {
+                expect_key = false;
+                break;
+            }
+            case ',':
+            {
+                if(depth > 0 && frames[depth - 1].array){
+                    frames[depth - 1].count++;
+                }
+                expect_key = depth > 0 && !frames[depth - 1].array;
+                break;
+            }
+            case '"':
+            {
+                // the index always has the closing quote right after the opening one
+                const size_t end {index[++k]};
+                const auto text {data.substr(i + 1, end - i - 1)};
+                if(expect_key)
+                {
+                    key = text;
                     break;
                 }
+                const auto p {find_path()};
+                if(p >= 0)
+                {
+                    found(p, {Json_Type::String, text, text.find('\\') != String_View::npos});
+                    if(left == 0 && array_done){
+                        return true;
+                    }
+                }
+                break;
             }
-            else {
+            default:
+            {
+                const auto p {find_path()};
+                if(p >= 0)
+                {
+                    // runs up to whatever comes next in the index, less the white space before it
+                    size_t end {k + 1 < n ? index[k + 1] : data.size()};
+                    while(end > i && (data[end - 1] == ' ' || data[end - 1] == '\t' || data[end - 1] == '\r' || data[end - 1] == '\n')){
+                        end--;
+                    }
+                    auto type {Json_Type::Number};
+                    if(c == 't'){
+                        type = Json_Type::True;
+                    }
+                    else if(c == 'f'){
+                        type = Json_Type::False;
+                    }
+                    else if(c == 'n'){
+                        type = Json_Type::Null;
+                    }
+                    found(p, {type, data.substr(i, end - i)});
+                    if(left == 0 && array_done){
+                        return true;
+                    }
+                }
                 break;
             }
         }
-        return result;
-    }};
+    }
+    return depth == 0;
+}
+
+inline bool json_read(const String_View data, const Json_Path* paths, const size_t path_count)
+{
+    auto none {[]{ return true; }};
+    return json_walk(data, paths, path_count, {}, nullptr, 0, none);
+}
 
-    auto result {get_value()};
+inline bool json_read(const String_View data, const std::initializer_list<Json_Path> paths)
+{
+    return json_read(data, paths.begin(), paths.size());
+}
 
-    return result;
+// json_read that also goes through the objects of the array at array_path, see json_walk
+template<typename Each>
+inline bool json_read_each(const String_View data, const std::initializer_list<Json_Path> paths,
+                           const String_View array_path, const std::initializer_list<Json_Path> element_paths, Each each)
+{
+    return json_walk(data, paths.begin(), paths.size(), array_path, element_paths.begin(), element_paths.size(), each);
 }
+
+// writes json into a buffer kept per thread, so building a body allocates nothing until text() copies it out.
+// commas go in by themselves and string values are escaped, keys are written as they are.
+// only one writer per thread at a time since they share the buffer
+struct Json_Writer
+{
+    Json_Writer() : buffer {thread_buffer()}
+    {
+        buffer.clear();
+    }
+
+    // key is left empty at the top and inside arrays
+    Json_Writer& object(const String_View key = {})
+    {
+        return open(key, '{', '}');
+    }
+
+    Json_Writer& array(const String_View key = {})
+    {
+        return open(key, '[', ']');
+    }
+
+    // closes the last object or array
+    Json_Writer& end()
+    {
+        if(depth > 0){
+            buffer.push_back(closers[--depth]);
+        }
+        first = false;
+        return *this;
+    }
+
+    Json_Writer& string(const String_View key, const String_View value)
+    {
+        write_key(key);
+        buffer.push_back('"');
+        size_t run {0};
+        for(size_t i = 0; i < value.size(); i++)
+        {
+            const auto c {(u8)value[i]};
+            if(c >= 0x20 && c != '"' && c != '\\'){
+                continue;
+            }
+            buffer.append(value.substr(run, i - run));
+            run = i + 1;
+            buffer.push_back('\\');
+            switch(c)
+            {
+                case '"':  buffer.push_back('"'); break;
+                case '\\': buffer.push_back('\\'); break;
+                case '\n': buffer.push_back('n'); break;
+                case '\r': buffer.push_back('r'); break;
+                case '\t': buffer.push_back('t'); break;
+                case '\b': buffer.push_back('b'); break;
+                case '\f': buffer.push_back('f'); break;
+                default:
+                {
+                    constexpr char hex[] {"0123456789abcdef"};
+                    buffer.append("u00");
+                    buffer.push_back(hex[c >> 4]);
+                    buffer.push_back(hex[c & 0xf]);
+                    break;
+                }
+            }
+        }
+        buffer.append(value.substr(run));
+        buffer.push_back('"');
+        return *this;
+    }
+
+    Json_Writer& number(const String_View key, const s64 value)
+    {
+        write_key(key);
+        char digits[24];
+        const auto result {std::to_chars(digits, digits + sizeof(digits), value)};
+        buffer.append(digits, result.ptr - digits);
+        return *this;
+    }
+
+    Json_Writer& boolean(const String_View key, const bool value)
+    {
+        write_key(key);
+        buffer.append(value ? "true" : "false");
+        return *this;
+    }
+
+    // anything left open is closed
+    String_View view()
+    {
+        while(depth > 0){
+            end();
+        }
+        return buffer;
+    }
+
+    String text()
+    {
+        return String{view()};
+    }
+
+    private:
+        static String& thread_buffer()
+        {
+            thread_local String b;
+            return b;
+        }
+
+        Json_Writer& open(const String_View key, const char opener, const char closer)
+        {
+            write_key(key);
+            buffer.push_back(opener);
+            if(depth < (int)sizeof(closers)){
+                closers[depth++] = closer;
+            }
+            first = true;
+            return *this;
+        }
+
+        void write_key(const String_View key)
+        {
+            if(!first){
+                buffer.push_back(',');
+            }
+            first = false;
+            if(!key.empty())
+            {
+                buffer.push_back('"');
+                buffer.append(key);
+                buffer.append("\":");
+            }
+        }
+
+        String& buffer;
+        char closers[16];
+        int depth {0};
+        bool first {true};
+};
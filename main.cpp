@@ -7,8 +7,12 @@
 
 #include <cstdio>
 #include <fstream>
+#include <sstream>
 #include <filesystem>
 #include <random>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Files = std::filesystem;
 
@@ -18,17 +22,17 @@ namespace Files = std::filesystem;
 #include "utilities.hpp"
 #include "youtube_api.hpp"
 #include "json.hpp"
+#include "queue.hpp"
+#include "irc.hpp"
+#include "worker_pool.hpp"
+#include "banned_words.hpp"
+#include "user_file.hpp"
+#include "helix.hpp"
 
-CURL* curl_handle {nullptr};
+Curl_Pool curl_pool;
 
 std::knuth_b GENERATOR;
 
-const String broadcaster_badge {"broadcaster"};
-const String moderator_badge   {"moderator"};
-const String vip_badge         {"vip"};
-const String founder_badge     {"founder"};
-const String subscriber_badge  {"subscriber"};
-
 String CLIENT_ID         {};
 String BROADCASTER_ID    {};
 String AUTH_TOKEN        {};
@@ -37,14 +41,88 @@ String BROADCASTER_NAME  {};
 String BOT_NAME          {};
 String TIKTOK_SESSION_ID {};
 
+// base urls, endpoints.txt can point any of them somewhere else like the mock server in mock/
+String HELIX_URL          {"https://api.twitch.tv/helix"};
+String YOUTUBE_URL        {"https://www.googleapis.com/youtube/v3"};
+String STREAMELEMENTS_URL {"https://api.streamelements.com/kappa/v2"};
+String NICE_GG_URL        {"https://nice.gg"};
+String TIKTOK_URL         {"https://api22-normal-c-useast1a.tiktokv.com"};
+String IRC_URL            {"wss://irc-ws.chat.twitch.tv:443"};
+String EVENT_SUB_URL      {"wss://eventsub.wss.twitch.tv/ws"};
+
+void load_endpoints(const String& path)
+{
+    std::ifstream file {path};
+    String line;
+    String tag;
+    String value;
+    while(std::getline(file, line))
+    {
+        clean_line(&line);
+        if(line.empty()){
+            continue;
+        }
+        extract_tag_and_value_from_line(line, &tag, &value);
+        if(tag == "Helix"){
+            HELIX_URL = value;
+        }
+        else if(tag == "Youtube"){
+            YOUTUBE_URL = value;
+        }
+        else if(tag == "StreamElements"){
+            STREAMELEMENTS_URL = value;
+        }
+        else if(tag == "Nice_GG"){
+            NICE_GG_URL = value;
+        }
+        else if(tag == "TikTok"){
+            TIKTOK_URL = value;
+        }
+        else if(tag == "Irc"){
+            IRC_URL = value;
+        }
+        else if(tag == "Event_Sub"){
+            EVENT_SUB_URL = value;
+        }
+        else{
+            printf("unknown endpoint %s in %s\n", tag.c_str(), path.c_str());
+        }
+    }
+}
+
 struct Parsed_Message
 {
-    String host;
-    String nick;
-    String message;
-    String user_id;
-    String badges;
-    bool reply;
+    // offsets into line instead of views so the message can be moved around the queues as is
+    struct Span
+    {
+        u32 offset {0};
+        u32 length {0};
+    };
+
+    String line;
+    Span nick_span;
+    Span message_span;
+    Span user_id_span;
+    Badges badges {0};
+    bool reply {false};
+
+    String_View nick() const
+    {
+        return get(nick_span);
+    }
+    String_View message() const
+    {
+        return get(message_span);
+    }
+    String_View user_id() const
+    {
+        return get(user_id_span);
+    }
+
+    String_View get(const Span s) const
+    {
+        return String_View{line}.substr(s.offset, s.length);
+    }
 };
 
 bool roll_dice(const int n)
@@ -88,114 +166,64 @@ String tts_text_format(const String& data)
     return result;
 }
 
-Parsed_Message parse_message(const String& msg)
+// irc was parsed from line, owner holds the same bytes starting at offset 0 and is moved into the result
+Parsed_Message parse_message(const String_View line, const Irc_Message& irc, String owner)
 {
-    if(msg.find("PRIVMSG") == msg.npos){
-        return {};
-    }
-
-    auto get_host {[&]()
+    const auto base {line.data()};
+    auto span {[base](const String_View v)
     {
-        auto colon {msg.find(" :") + 2};
-        return msg.substr(colon, msg.find(" ", colon + 1) - colon);
-    }};
-
-    auto get_nick {[&]()
-    {
-        auto colon {msg.find(" :") + 2};
-        return msg.substr(colon, msg.find("!", colon + 1) - colon);
-    }};
-
-    auto get_message_start {[&]()
-    {
-        auto fc {msg.find(" :")};
-        auto colon {msg.find(" :", fc + 2)};
-        return colon + 2;
-    }};
-
-    auto get_message {[&]()
-    {
-        return msg.substr(get_message_start(), msg.npos);
-    }};
-
-    auto get_badges {[&]()
-    {
-        const auto badge_badge {"badges="};
-        auto b_pos {msg.find(badge_badge)}; 
-        const auto bl {strlen(badge_badge)};
-        Vector<String> badges {moderator_badge, broadcaster_badge, vip_badge, founder_badge, subscriber_badge};
-        String result;
-        if(b_pos != String::npos)
-        {
-            const auto semi_colon {msg.find(';', b_pos + bl + 1)};
-            auto start {b_pos + bl};
-            auto badge {msg.find("/", start)};
-            while(badge != String::npos)
-            {
-                result += msg.substr(start, badge - start);
-                result += " ";
-                start = badge + 2;
-                if(start >= semi_colon){
-                    break;
-                }
-                badge = msg.find("/", start);
-            }
+        if(v.empty()){
+            return Parsed_Message::Span{};
         }
-
-        return result;
-    }};
-
-    auto get_user_id {[&]()
-    {
-        const auto user_id {"user-id="};
-        auto pos {msg.find(user_id)};
-        pos += 8;
-        return msg.substr(pos, msg.find(';', pos) - pos);
+        return Parsed_Message::Span{(u32)(v.data() - base), (u32)v.size()};
     }};
 
     Parsed_Message result;
+    result.nick_span    = span(irc.nick);
+    result.message_span = span(irc.trailing);
+    result.user_id_span = span(irc.get_tag("user-id"));
+    result.badges       = parse_badges(irc.get_tag("badges"));
+    result.reply        = irc.has_tag("reply-parent-msg-id");
+    result.line         = std::move(owner);
 
-    result.host = get_host();
-    result.nick = get_nick();
-    result.message = get_message();
-    result.badges = get_badges();
-    result.user_id = get_user_id();
+    return result;
+}
+
+void push_message(Connection_Metadata* m, String message)
+{
+    // the ring only fills up if the message thread is stuck, wake it and wait for room
+    while(!m->messages.push(std::move(message)))
     {
-        auto r {msg.find("reply")};
-        result.reply = r != String::npos && r < get_message_start();
+        if(m->message_event){
+            m->message_event->notify();
+        }
+        std::this_thread::yield();
     }
-
-    clean_line(&result.host);
-    clean_line(&result.nick);
-    clean_line(&result.message);
-    clean_line(&result.badges);
-    clean_line(&result.user_id);
-
-    return result;
 }
 
 void twitch_irc_message_handler(Connection_Metadata* m, Client::message_ptr msg)
 {
-    std::scoped_lock g {m->message_mutex};
     auto pay_load {msg->get_payload()};
-    if(msg->get_opcode() == websocketpp::frame::opcode::text){
-        m->messages.push_back(pay_load);
+    if(msg->get_opcode() == websocketpp::frame::opcode::text)
+    {
+        printf("%s : %s\n", m->name.c_str(), pay_load.c_str());
+        push_message(m, std::move(pay_load));
     }
-    else{
+    else
+    {
         pay_load = websocketpp::utility::to_hex(pay_load);
+        printf("%s : %s\n", m->name.c_str(), pay_load.c_str());
     }
-    printf("%s : %s\n", m->name.c_str(), pay_load.c_str());
 }
 
 void event_sub_message_handler(Connection_Metadata* m, Client::message_ptr msg)
 {
-    std::scoped_lock g {m->message_mutex};
     auto pay_load {msg->get_payload()};
     if(msg->get_opcode() != websocketpp::frame::opcode::text){
         pay_load = websocketpp::utility::to_hex(pay_load);
     }
-    m->messages.push_back("<< " + pay_load);
     printf("%s : %s\n", m->name.c_str(), pay_load.c_str());
+    push_message(m, "<< " + pay_load);
 }
 
 struct User
@@ -204,23 +232,26 @@ struct User
     String user_login {""};
 
     String last_known_nick {};
-    String last_known_badges;
+    Badges last_known_badges {0};
 
     s64 points        {0}; 
     s64 gamba_points  {0};
     s64 social_credit {0};
 
+    // changed since the last save, see User_Store::touch
+    bool dirty {false};
+
     bool stronger(const User& b)
     {
-        const bool a_has_bc  {last_known_badges.find(broadcaster_badge) != String::npos};
-        const bool a_has_mod {last_known_badges.find(moderator_badge) != String::npos};
-        const bool a_has_vip {last_known_badges.find(vip_badge) != String::npos};
-        const bool a_has_sub {last_known_badges.find(subscriber_badge) != String::npos};
+        const bool a_has_bc  {(last_known_badges & broadcaster_badge) != 0};
+        const bool a_has_mod {(last_known_badges & moderator_badge) != 0};
+        const bool a_has_vip {(last_known_badges & vip_badge) != 0};
+        const bool a_has_sub {(last_known_badges & subscriber_badge) != 0};
 
-        const bool b_has_bc  {b.last_known_badges.find(broadcaster_badge) != String::npos};
-        const bool b_has_mod {b.last_known_badges.find(moderator_badge) != String::npos};
-        const bool b_has_vip {b.last_known_badges.find(vip_badge) != String::npos};
-        const bool b_has_sub {b.last_known_badges.find(subscriber_badge) != String::npos};
+        const bool b_has_bc  {(b.last_known_badges & broadcaster_badge) != 0};
+        const bool b_has_mod {(b.last_known_badges & moderator_badge) != 0};
+        const bool b_has_vip {(b.last_known_badges & vip_badge) != 0};
+        const bool b_has_sub {(b.last_known_badges & subscriber_badge) != 0};
 
         if(a_has_bc){
             return true;
@@ -257,17 +288,167 @@ struct User
         }
         return false;
     }
+};
+
+// users live in a deque so pointers handed out stay valid while new ones get appended.
+// the indexes are keyed by hash so lookups with a String_View don't allocate,
+// last_known_nick has to be changed through set_nick to keep them right
+struct User_Store
+{
+    User* add(User user)
+    {
+        users.push_back(std::move(user));
+        auto u {&users.back()};
+        by_id.insert({hash_string(u->user_id), u});
+        if(!u->last_known_nick.empty()){
+            by_nick.insert({hash_string(u->last_known_nick), u});
+        }
+        return u;
+    }
+
+    User* get(const String_View id)
+    {
+        auto range {by_id.equal_range(hash_string(id))};
+        for(auto i = range.first; i != range.second; i++)
+        {
+            if(i->second->user_id == id){
+                return i->second;
+            }
+        }
+        return nullptr;
+    }
+
+    User* get_by_nick(const String_View nick)
+    {
+        auto range {by_nick.equal_range(hash_string(nick))};
+        for(auto i = range.first; i != range.second; i++)
+        {
+            if(i->second->last_known_nick == nick){
+                return i->second;
+            }
+        }
+        return nullptr;
+    }
+
+    void set_nick(User* u, const String_View nick)
+    {
+        if(u->last_known_nick == nick){
+            return;
+        }
+        if(!u->last_known_nick.empty())
+        {
+            auto range {by_nick.equal_range(hash_string(u->last_known_nick))};
+            for(auto i = range.first; i != range.second; i++)
+            {
+                if(i->second == u)
+                {
+                    by_nick.erase(i);
+                    break;
+                }
+            }
+        }
+        u->last_known_nick = nick;
+        if(!nick.empty()){
+            by_nick.insert({hash_string(nick), u});
+        }
+    }
+
+    // call after changing points, gamba_points or social_credit so the next save picks it up
+    void touch(User* u)
+    {
+        if(!u->dirty)
+        {
+            u->dirty = true;
+            dirty.push_back(u);
+        }
+    }
+
+    Vector<User> take_dirty()
+    {
+        Vector<User> result;
+        result.reserve(dirty.size());
+        for(auto u : dirty)
+        {
+            u->dirty = false;
+            result.push_back(*u);
+        }
+        dirty.clear();
+        return result;
+    }
+
+    void reserve(const size_t n)
+    {
+        by_id.reserve(n);
+        by_nick.reserve(n);
+    }
 
-    void serialize_out(std::ostream* data)
+    size_t size() const
     {
-        auto& i {*data};
-        i<<"User : " <<user_id<<"\n\n";
-        i<<"\tPoints : " <<points<<"\n\n";
-        i<<"\tGamba_Points : " <<gamba_points<<"\n\n";
-        i<<"\tSocial_Credit : " <<social_credit<<"\n\n";
+        return users.size();
     }
+
+    bool empty() const
+    {
+        return users.empty();
+    }
+
+    auto begin()
+    {
+        return users.begin();
+    }
+
+    auto end()
+    {
+        return users.end();
+    }
+
+    private:
+        std::deque<User> users;
+        std::unordered_multimap<u64, User*> by_id;
+        std::unordered_multimap<u64, User*> by_nick;
+        Vector<User*> dirty;
 };
 
+// reads the old followers.txt format, records are appended in file order so later ones win when merging
+void load_users_file(const String& path, Vector<User>* out)
+{
+    String line;
+    String tag;
+    String value;
+
+    std::ifstream o {path};
+    User* current {nullptr};
+    while(std::getline(o, line))
+    {
+        clean_line(&line);
+        if(line != "End")
+        {
+            if(!line.empty())
+            {
+                extract_tag_and_value_from_line(line, &tag, &value);
+                if(tag == "User")
+                {
+                    out->push_back({});
+                    current = &out->back();
+                    current->user_id = value;
+                }
+                else if(!current){
+                    continue;
+                }
+                else if(tag == "Points"){
+                    string_to_int(value, &current->points);
+                }
+                else if(tag == "Gamba_Points"){
+                    string_to_int(value, &current->gamba_points);
+                }
+                else if(tag == "Social_Credit"){
+                    string_to_int(value, &current->social_credit);
+                }
+            }
+        }
+    }
+}
+
 struct Bot
 {
 
@@ -337,13 +518,25 @@ struct Bot
     {
         String name;
         Callback callback;
-        Vector<String> badges;
+        // any one of these is enough, 0 means anybody
+        Badges badges;
         bool no_badges;
         bool enabled   {true};
         bool togglable {true};
+        // a reply's "@someone" is passed on as the first argument
+        bool takes_reply_target {false};
+        // 0 means no limit
+        int max_running {4};
+        std::unique_ptr<std::atomic<int>> running {std::make_unique<std::atomic<int>>(0)};
     };
 
-    void add_command(const String& name, Callback c, const Vector<String>& badges = {}, const bool no_badges = false)
+    struct Command_Slot
+    {
+        u64 hash  {0};
+        int index {-1};
+    };
+
+    void add_command(const String& name, Callback c, const Badges badges = 0, const bool no_badges = false)
     {
         if(experimental){
             commands.push_back({"_" + name, c, badges, no_badges});
@@ -351,243 +544,293 @@ struct Bot
         else{
             commands.push_back({name, c, badges, no_badges});
         }
+        build_command_table();
     }
 
-    Command* find_command(const String& name)
+    // open addressing table of indices into commands, kept at most half full
+    void build_command_table()
     {
-        for(auto& c : commands)
+        size_t size {16};
+        while(size < commands.size() * 2){
+            size <<= 1;
+        }
+        command_table.assign(size, {});
+        for(int i = 0; i < commands.size(); i++)
         {
-            if(c.name == name){
-                return &c;
+            const auto hash {hash_string(commands[i].name)};
+            auto slot {hash & (size - 1)};
+            while(command_table[slot].index != -1){
+                slot = (slot + 1) & (size - 1);
             }
+            command_table[slot] = {hash, i};
+        }
+    }
+
+    Command* find_command(const String_View name)
+    {
+        if(command_table.empty()){
+            return nullptr;
+        }
+        const auto mask {command_table.size() - 1};
+        const auto hash {hash_string(name)};
+        auto slot {hash & mask};
+        while(command_table[slot].index != -1)
+        {
+            const auto& s {command_table[slot]};
+            if(s.hash == hash && commands[s.index].name == name){
+                return &commands[s.index];
+            }
+            slot = (slot + 1) & mask;
         }
         return nullptr;
     }
 
-    void check_messages()
+    void handle_event_sub_message(const String& data)
     {
-        std::scoped_lock g {generic_mutex};
+        Json_Value message_type;
+        Json_Value subscription_type;
+        Json_Value user_name;
+        Json_Value event_user_id;
+        json_read(data, {{"metadata.message_type", &message_type},
+                         {"metadata.subscription_type", &subscription_type},
+                         {"payload.event.user_name", &user_name},
+                         {"payload.event.user_id", &event_user_id}});
+
+        if(message_type.view() == "notification")
         {
-            std::scoped_lock g {event_sub_handle->message_mutex};
-            if(!event_sub_handle->messages.empty())
+            const auto type {subscription_type.view()};
+            String s;
+            String message;
+            if(type == "channel.follow")
             {
-                if(event_sub_session_id.empty())
+                s = user_name.string();
+                auto user_id {event_user_id.string()};
+                auto found {false};
+                for(auto& u : already_thanks_for_the_follow)
                 {
-                    auto ctr {0};
-                    for(const auto& s : event_sub_handle->messages)
-                    {
-                        event_sub_session_id = json_get_value_naive("id", s);
-                        clean_line(&event_sub_session_id);
-                        if(!event_sub_session_id.empty()){
-                            break;
-                        }
-                        ctr++;
-                    }
-                    if(!event_sub_session_id.empty())
+                    if(u == user_id)
                     {
-                        subscribe_to_event("channel.follow",
-                                            2,
-                                            wrap_in_quotes("condition") + ":{" + 
-                                            wrap_in_quotes("broadcaster_user_id") + ":" + wrap_in_quotes(BROADCASTER_ID) + "," +
-                                            wrap_in_quotes("moderator_user_id") + ":" + wrap_in_quotes(BROADCASTER_ID) + "}");
-
-                        subscribe_to_event("channel.subscribe",
-                                            1,
-                                            wrap_in_quotes("condition") + ":{" + 
-                                            wrap_in_quotes("broadcaster_user_id") + ":" + wrap_in_quotes(BROADCASTER_ID) + "}");
-
-                        event_sub_handle->messages.erase(event_sub_handle->messages.begin() + ctr);
+                        found = true;
+                        break;
                     }
                 }
-                else
+                if(!found){
+                    found = users.get(user_id) != nullptr;
+                }
+                if(!found)
                 {
-                    auto data {event_sub_handle->messages.front()};
-                    auto s {json_get_value_naive("message_type", data)};
+                    add_message(format_reply_2("Yo lilbro thanks for the follow!", s));
+                    message = tts_text_format(s + " thanks for the follow lil bro");
 
-                    event_sub_handle->messages.erase(event_sub_handle->messages.begin());
+                    already_thanks_for_the_follow.push_back(user_id);
+                    users.touch(users.add({user_id}));
+                }
+            }
+            else if(type == "channel.subscribe" || type == "channel.subscription.message")
+            {
+                s = user_name.string();
+                add_message(format_reply_2("Yo lilbro thanks for subbing!", s));
+                message = tts_text_format(s + " thanks for the subbing lil bro!");
+            }
+            if(!message.empty())
+            {
+                auto thank_you {tts_from_streamelements("Brian", message)};
+                if(thank_you.tts)
+                {
+                    std::scoped_lock g {sound_mutex};
+                    sounds_to_play.push_back(thank_you);
+                    sound_event.notify();
+                }
+            }
+        }
+    }
 
-                    if(s == "notification")
+    void handle_priv_message(const Parsed_Message& msg)
+    {
+        const String_View nick {msg.nick()};
+        const String user_id {msg.user_id()};
+        const auto badges {msg.badges};
+        auto tokens {tokenize(msg.message())};
+        String to_who;
+        if(msg.reply)
+        {
+            to_who = tokens.front();
+            tokens.erase(tokens.begin());
+        }
+        for(const auto& s : tokens)
+        {
+            if(s == "BatChest"){
+                batchest_count++;
+            }
+        }
+        {
+            auto u {get_user(user_id)};
+            if(u)
+            {
+                u->last_known_badges = badges;
+                users.set_nick(u, nick);
+            }
+        }
+        auto has_command {false};
+        if(!tokens.empty() && tokens[0][0] == '!')
+        {
+            auto c {find_command(String_View{tokens[0]}.substr(1))};
+            if(c && c->enabled)
+            {
+                has_command = true;
+                bool badge_is_good {};
+                if(c->no_badges){
+                    badge_is_good = badges == 0; 
+                }
+                else{
+                    badge_is_good = c->badges == 0 || (c->badges & badges) != 0;
+                }
+                if(badge_is_good)
+                {
+                    tokens.erase(tokens.begin());
+                    tokens.insert(tokens.begin(), String{nick});
+                    if(c->takes_reply_target && !to_who.empty()){
+                        tokens.insert(tokens.begin() + 1, to_who);
+                    }
+                    if(c->max_running > 0 && *c->running >= c->max_running){
+                        add_message(format_reply(String{nick}, "slow down, too many !" + c->name + " going already"));
+                    }
+                    else
                     {
-                        s = json_get_value_naive("subscription_type", data);
-                        String message;
-                        if(s == "channel.follow")
-                        {
-                            s = json_get_value_naive("user_name", data);
-                            auto user_id {json_get_value_naive("user_id", data)};
-                            auto found {false};
-                            for(auto& u : already_thanks_for_the_follow)
-                            {
-                                if(u == user_id)
-                                {
-                                    found = true;
-                                    break;
-                                }
-                            }
-                            if(!found)
+                        auto running {c->running.get()};
+                        (*running)++;
+                        workers.submit([this, callback = c->callback, user_id, tokens = std::move(tokens), running]{
+                            // let go of the slot even if the callback throws, or the command stays at max_running
+                            struct Release
                             {
-                                for(auto& u : users)
+                                std::atomic<int>* running;
+                                ~Release()
                                 {
-                                    if(u.user_id == user_id)
-                                    {
-                                        found = true;
-                                        break;
-                                    }
+                                    (*running)--;
                                 }
-                            }
-                            if(!found)
-                            {
-                                add_message(format_reply_2("Yo lilbro thanks for the follow!", s));
-                                message = tts_text_format(s + " thanks for the follow lil bro");
-
-                                already_thanks_for_the_follow.push_back(user_id);
-                                users.push_back({user_id});
-                            }
-                        }
-                        else if(s == "channel.subscribe" || s == "channel.subscription.message")
-                        {
-                            s = json_get_value_naive("user_name", data);
-                            add_message(format_reply_2("Yo lilbro thanks for subbing!", s));
-                            message = tts_text_format(s + " thanks for the subbing lil bro!");
-                        }
-                        if(!message.empty())
-                        {
-                            auto thank_you {tts_from_streamelements("Brian", message)};
-                            if(thank_you.tts)
-                            {
-                                std::scoped_lock g {sound_mutex};
-                                sounds_to_play.push_back(thank_you);
-                            }
-                        }
+                            } release {running};
+                            callback(this, user_id, tokens);
+                        });
                     }
                 }
+                else{
+                    add_message(format_reply(String{nick}, "You are not BatChest enough!"));
+                }
             }
-        } 
+        }
+        if(!has_command)
         {
-            std::scoped_lock g {handle->message_mutex};
-            for(auto& m : handle->messages)
+            auto matcher {std::atomic_load(&banned_words)};
+            if(matcher)
             {
-                if(m.find("JOIN") != String::npos){
-                    handle->joined = true;
+                Banned_Word_Matcher::Scan scan;
+                for(const auto& s : tokens)
+                {
+                    matcher->feed(&scan, s);
+                    matcher->feed(&scan, " ");
                 }
-                else
+                if(scan.found && to_who.empty())
                 {
-                    auto parsed_message {parse_message(m)};
-                    if(!parsed_message.message.empty()){
-                        priv_messages.push_back(parsed_message);
-                    }
-                    else
-                    {
-                        auto tokens {tokenize(m)};
-                        if(!tokens.empty())
-                        {
-                            if(tokens[0] == "PING"){
-                                ping_messages.push_back(m);
-                            }
-                        }
-                    }
+                    ban_user(user_id, scan.duration);
                 }
             }
-            handle->messages.clear();
         }
-        if(!priv_messages.empty())
+    }
+
+    void check_messages()
+    {
+        std::unique_lock g {generic_mutex};
+        String m;
+        // subscribing goes through the helix queue, so it's done after the lock is let go
+        String new_session_id;
         {
-            const auto& msg {priv_messages.front()};
-            auto tokens {tokenize(msg.message)};
-            String to_who;
-            if(msg.reply)
+            while(event_sub_handle->messages.pop(&m)){
+                event_sub_messages.push_back(std::move(m));
+            }
+            if(event_sub_session_id.empty())
             {
-                to_who = tokens.front();
-                tokens.erase(tokens.begin());
+                while(!event_sub_messages.empty())
+                {
+                    Json_Value session_id;
+                    json_read(event_sub_messages.front(), {{"payload.session.id", &session_id}});
+                    event_sub_session_id = session_id.string();
+                    event_sub_messages.pop_front();
+                    if(!event_sub_session_id.empty())
+                    {
+                        new_session_id = event_sub_session_id;
+                        break;
+                    }
+                }
             }
+            if(!event_sub_session_id.empty())
             {
-                auto u {get_user(msg.user_id)};
-                if(u)
+                while(!event_sub_messages.empty())
                 {
-                    u->last_known_badges = msg.badges;
-                    u->last_known_nick = msg.nick;
+                    handle_event_sub_message(event_sub_messages.front());
+                    event_sub_messages.pop_front();
                 }
             }
-            auto has_command {false};
-            if(tokens[0][0] == '!')
+        } 
+        {
+            // drain everything the websocket thread has handed over so far
+            Irc_Message irc;
+            while(handle->messages.pop(&m))
             {
-                auto c {find_command(tokens[0].substr(1, String::npos))};
-                if(c && c->enabled)
+                String_View frame {m};
+                while(!frame.empty())
                 {
-                    has_command = true;
-                    bool badge_is_good {};
-                    if(c->no_badges){
-                        badge_is_good = msg.badges.empty(); 
+                    const auto line {irc_next_line(&frame)};
+                    if(!parse_irc_message(line, &irc)){
+                        continue;
                     }
-                    else
+                    if(irc.command == "PRIVMSG")
                     {
-                        badge_is_good = c->badges.empty();
-                        for(const auto& s : c->badges)
-                        {
-                            if(msg.badges.find(s) != String::npos)
-                            {
-                                badge_is_good = true;
-                                break;
-                            }
+                        if(irc.trailing.empty()){
+                            continue;
                         }
-                    }
-                    if(badge_is_good)
-                    {
-                        tokens.erase(tokens.begin());
-                        tokens.insert(tokens.begin(), msg.nick);
-                        if(c->name == "tts" && !to_who.empty()){
-                            tokens.insert(tokens.begin() + 1, to_who);
+                        // the usual one line frame is handed over without a copy
+                        if(frame.empty() && line.data() == m.data()){
+                            priv_messages.push_back(parse_message(line, irc, std::move(m)));
+                        }
+                        else{
+                            priv_messages.push_back(parse_message(line, irc, String{line}));
                         }
-                        auto t {std::thread(c->callback, this, msg.user_id, tokens)};
-                        t.detach();
                     }
-                    else{
-                        add_message(format_reply(msg.nick, "You are not BatChest enough!"));
+                    else if(irc.command == "PING"){
+                        ping_messages.push_back(String{line} + "\r\n");
                     }
-                }
-            }
-            if(!has_command)
-            {
-                String str;
-                for(const auto& s : tokens)
-                {
-                    str += s;
-                    str += ' ';
-                }
-                string_decapitalize(&str);
-                int duration {0};
-                auto has_banned_word {false};
-                for(const auto& p : banned_words)
-                {
-                    auto start {0};
-                    auto pos {str.find(p.first)};
-                    while(pos != String::npos)
-                    {
-                        start = pos + 1;
-                        duration += p.second;
-                        has_banned_word = true;
-                        pos = str.find(p.first, start);
+                    else if(irc.command == "JOIN"){
+                        handle->joined = true;
                     }
                 }
-                if(has_banned_word && to_who.empty()){
-                    ban_user(msg.user_id, duration);
-                }
             }
-            for(const auto& s : tokens)
+        }
+        {
+            size_t count {priv_messages.size()};
+            if(messages_per_tick > 0 && count > messages_per_tick){
+                count = messages_per_tick;
+            }
+            for(size_t i = 0; i < count; i++)
             {
-                if(s == "BatChest"){
-                    batchest_count++;
-                }
+                handle_priv_message(priv_messages.front());
+                priv_messages.pop_front();
             }
-            priv_messages.erase(priv_messages.begin());
+            messages_handled += count;
         }
-        if(!ping_messages.empty())
+        while(!ping_messages.empty())
         {
             auto& pong {ping_messages.front()};
             pong[1] = 'O';
             add_message(pong);
             printf("%s\n", pong.c_str());
-            ping_messages.erase(ping_messages.begin());
+            ping_messages.pop_front();
+        }
+
+        backlog_depth = priv_messages.size();
+        if(backlog_depth > peak_backlog_depth){
+            peak_backlog_depth = backlog_depth.load();
         }
+
         if(!periodic_messages.empty())
         {
             if(!periodic_timer.started || periodic_timer.is_time())
@@ -600,6 +843,15 @@ struct Bot
                 periodic_timer.start(60 * 15);
             }
         }
+        g.unlock();
+
+        if(!new_session_id.empty())
+        {
+            subscribe_to_event(new_session_id, "channel.follow", 2, {{"broadcaster_user_id", BROADCASTER_ID},
+                                                                     {"moderator_user_id", BROADCASTER_ID}});
+
+            subscribe_to_event(new_session_id, "channel.subscribe", 1, {{"broadcaster_user_id", BROADCASTER_ID}});
+        }
     }
 
     void check_music_queue()
@@ -625,23 +877,23 @@ struct Bot
 
                     const auto mv {0.08f};
 
+                    // full volume unless a valid one was asked for
+                    auto volume {1.f};
                     if(music.args.size() >= 3){
-                        Mix_VolumeMusic((float)MIX_MAX_VOLUME * mv * string_to_float(music.args[2]));
-                    }
-                    else{
-                        Mix_VolumeMusic((float)MIX_MAX_VOLUME * mv);
+                        string_to_float(music.args[2], &volume);
                     }
+                    Mix_VolumeMusic((float)MIX_MAX_VOLUME * mv * volume);
 
                     Mix_PlayMusic(current_music, 0);
                     add_message(format_reply_2("Song : " + music.video.title + " requested ->", music.args[0]));
                     last_song = music;
                     last_music_stamp = Clock::now();
-                    music_queue.erase(music_queue.begin());
+                    music_queue.pop_front();
                 }
                 else
                 {
-                    music_queue.erase(music_queue.begin());
                     add_message(format_reply(music.args[0], "something went wrong..."));
+                    music_queue.pop_front();
                 }
             }
         }
@@ -659,7 +911,7 @@ struct Bot
                     s.pause.start();
                 }
                 else if(s.pause.is_time()){
-                    sounds_to_play.erase(sounds_to_play.begin());
+                    sounds_to_play.pop_front();
                 }
             }
             else
@@ -672,7 +924,7 @@ struct Bot
                     if(!Mix_Playing(s.channel))
                     {
                         s.clean_up();
-                        sounds_to_play.erase(sounds_to_play.begin());
+                        sounds_to_play.pop_front();
                     }
                 }
             }
@@ -683,13 +935,106 @@ struct Bot
             if(!Mix_Playing(s.channel))
             {
                 s.clean_up();
-                tts_sounds_to_play_elevated.erase(tts_sounds_to_play_elevated.begin());
+                tts_sounds_to_play_elevated.pop_front();
+            }
+        }
+    }
+
+    void wait_for_messages()
+    {
+        {
+            std::scoped_lock g {generic_mutex};
+            if(!priv_messages.empty() || !ping_messages.empty()){
+                return;
+            }
+            if(!event_sub_handle->messages.empty() || !handle->messages.empty()){
+                return;
+            }
+        }
+        if(periodic_messages.empty()){
+            message_event.wait();
+        }
+        else{
+            message_event.wait(periodic_timer.time_left());
+        }
+    }
+
+    void wait_for_music()
+    {
+        auto wait_time {-1.f};
+        {
+            std::scoped_lock g {music_mutex};
+            if(!music_queue.empty())
+            {
+                if(!music_playing()){
+                    return;
+                }
+                Duration d {Clock::now() - last_music_stamp};
+                wait_time = last_song.video.duration - d.count();
+            }
+        }
+        if(wait_time < 0){
+            music_event.wait();
+        }
+        else{
+            music_event.wait(wait_time);
+        }
+    }
+
+    void wait_for_sounds()
+    {
+        // a playing sound wakes us up through Mix_ChannelFinished, the timeout is
+        // there in case a channel never started
+        const auto playing_timeout {1.f};
+        auto wait_time {-1.f};
+        {
+            std::scoped_lock g {sound_mutex};
+            if(!sounds_to_play.empty())
+            {
+                auto& s {sounds_to_play.front()};
+                if(s.pause.wait > 0)
+                {
+                    if(!s.pause.started){
+                        return;
+                    }
+                    wait_time = s.pause.time_left();
+                }
+                else
+                {
+                    if(!s.played){
+                        return;
+                    }
+                    wait_time = playing_timeout;
+                }
+            }
+            else if(!tts_sounds_to_play_elevated.empty()){
+                wait_time = playing_timeout;
+            }
+        }
+        if(wait_time < 0){
+            sound_event.wait();
+        }
+        else{
+            sound_event.wait(wait_time);
+        }
+    }
+
+    void wait_for_messages_to_send()
+    {
+        {
+            std::scoped_lock g {send_mutex};
+            if(!messages_to_send.empty()){
+                return;
             }
         }
+        send_event.wait();
     }
 
     Sound* get_sound(const String& s)
     {
+        if(!sounds_loaded.load(std::memory_order_acquire)){
+            return nullptr;
+        }
         for(auto& sound : sounds)
         {
             if(sound.name == s){
@@ -719,11 +1064,10 @@ struct Bot
 
     Sound_To_Play tts_from_nice_gg(const String& phrase)
     {
-        std::scoped_lock gg {curl_mutex};
-        curl_easy_reset(curl_handle);
+        auto handle {curl_pool.acquire()};
         Sound_To_Play play;
-        String url {"https://nice.gg/tts?msg=" + phrase + "&tiktok_session_id=" + TIKTOK_SESSION_ID};
-        const String data {curl_call(url, curl_handle)};
+        String url {NICE_GG_URL + "/tts?msg=" + phrase + "&tiktok_session_id=" + TIKTOK_SESSION_ID};
+        const String data {curl_call(url, handle)};
 
         auto rwops {SDL_RWFromConstMem((void*)data.data(), data.length())};
         if(rwops)
@@ -736,12 +1080,11 @@ struct Bot
 
     Sound_To_Play tts_from_streamelements(String voice, const String& phrase)
     {
-        std::scoped_lock gg {curl_mutex};
-        curl_easy_reset(curl_handle);
+        auto handle {curl_pool.acquire()};
         Sound_To_Play play;
         voice[0] = toupper(voice[0]);
-        String url {"https://api.streamelements.com/kappa/v2/speech?voice=" + voice + "&text="};
-        const String data {curl_call(url + phrase, curl_handle)};
+        String url {STREAMELEMENTS_URL + "/speech?voice=" + voice + "&text="};
+        const String data {curl_call(url + phrase, handle)};
 
         auto rwops {SDL_RWFromConstMem((void*)data.data(), data.length())};
         if(rwops)
@@ -754,22 +1097,23 @@ struct Bot
 
     Sound_To_Play tts_from_tiktok(String voice, const String& phrase)
     {
-        std::scoped_lock gg {curl_mutex};
-        curl_easy_reset(curl_handle);
+        auto handle {curl_pool.acquire()};
         Sound_To_Play play;
 
         auto list {set_curl_headers((String{"User-Agent"} + ":" + " com.zhiliaoapp.musically/2022600030 (Linux; U; Android 7.1.2; es_ES; SM-G988N; Build/NRD90M;tt-ok/3.12.13.1)").c_str(),
                                      (String{"Cookie"} + ":" + " sessionid=" + TIKTOK_SESSION_ID).c_str(), 
                                      (String{"Content-Length"} + ":" + "0").c_str())};
 
-        curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, list);
-        curl_easy_setopt(curl_handle, CURLOPT_CUSTOMREQUEST, "POST");
+        curl_easy_setopt(handle, CURLOPT_HTTPHEADER, list);
+        curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, "POST");
 
-        String url {"https://api22-normal-c-useast1a.tiktokv.com/media/api/text/speech/invoke/?text_speaker=" + voice + "&req_text=" + phrase + "&speaker_map_type=0&aid=1233"};
+        String url {TIKTOK_URL + "/media/api/text/speech/invoke/?text_speaker=" + voice + "&req_text=" + phrase + "&speaker_map_type=0&aid=1233"};
 
-        const String data {curl_call(url, curl_handle)};
+        const String data {curl_call(url, handle)};
 
-        auto b64 {json_get_value_naive("v_str", data)};
+        Json_Value v_str;
+        json_read(data, {{"data.v_str", &v_str}});
+        auto b64 {v_str.string()};
 
         auto file {websocketpp::base64_decode(b64)};
 
@@ -807,199 +1151,314 @@ struct Bot
     void send_messages()
     {
         std::scoped_lock g {send_mutex};
-        for(const auto& s : messages_to_send){
-            end_point.send(connection_id, s);
+        while(!messages_to_send.empty())
+        {
+            end_point.send(connection_id, messages_to_send.front());
+            messages_to_send.pop_front();
         }
-        messages_to_send.clear();
     }
 
     void add_message(const String& str)
     {
-        std::scoped_lock g {send_mutex};
-        messages_to_send.push_back(str);
+        {
+            std::scoped_lock g {send_mutex};
+            messages_to_send.push_back(str);
+        }
+        send_event.notify();
     }
 
-    User* get_user(const String& id)
+    User* get_user(const String_View id)
     {
-        for(auto& u : users)
+        return users.get(id);
+    }
+    User* get_user_by_nick(const String_View nick)
+    {
+        if(nick.empty()){
+            return nullptr;
+        }
+        return users.get_by_nick(nick);
+    }
+
+    void ban_user(const String& id, const int dur)
+    {
+        if(id.empty())
         {
-            if(u.user_id == id){
-                return &u;
+            printf("can't ban without a user id\n");
+            return;
+        }
+        String url {HELIX_URL + "/moderation/bans?broadcaster_id=" + BROADCASTER_ID + "&moderator_id=" + BROADCASTER_ID}; 
+
+        Json_Writer body;
+        body.object().object("data").string("user_id", id);
+        if(dur != -1){
+            body.number("duration", dur);
+        }
+        // nothing waits on the answer, a rate limited ban can sit in the queue for a while
+        helix.submit({Helix_Client::Moderation, "POST", url, body.text()}, [id](Helix_Client::Response response){
+            if(response.status != 200){
+                printf("ban of %s failed with %li : %s\n", id.c_str(), response.status, response.body.c_str());
+            }
+        });
+    }
+
+    // condition is the key value pairs twitch wants for the type, like broadcaster_user_id
+    void subscribe_to_event(const String& session_id, const String& s, const int v,
+                            const std::initializer_list<Pair<String_View, String_View>> condition)
+    {
+        String url {HELIX_URL + "/eventsub/subscriptions"}; 
+
+        // twitch wants the version as a string
+        char version[16];
+        const auto version_end {std::to_chars(version, version + sizeof(version), v).ptr};
+
+        Json_Writer body;
+        body.object().string("type", s).string("version", String_View{version, (size_t)(version_end - version)});
+        body.object("condition");
+        for(const auto& c : condition){
+            body.string(c.first, c.second);
+        }
+        body.end();
+        body.object("transport").string("method", "websocket").string("session_id", session_id).end();
+        helix.submit({Helix_Client::Normal, "POST", url, body.text()}, [s](Helix_Client::Response response){
+            if(response.status != 202){
+                printf("subscribing to %s failed with %li : %s\n", s.c_str(), response.status, response.body.c_str());
+            }
+        });
+    }
+
+    struct Follower
+    {
+        String user_id;
+        String user_login;
+        s64 followed_at {0};
+    };
+
+    // helix hands follows out newest first, paging stops at the first one older than since. total is
+    // how many follow the channel right now by the first page. false if a page failed, out then only
+    // has the pages before it and shouldn't be taken as the whole list
+    bool fetch_followers(const s64 since, Vector<Follower>* out, int* page_count, s64* total)
+    {
+        String url {HELIX_URL + "/channels/followers?broadcaster_id=" + BROADCASTER_ID + "&first=100"};
+        auto response {helix.call({Helix_Client::Bulk, "GET", url})};
+        *page_count = 1;
+        *total = -1;
+        auto done {false};
+        Json_Value total_value;
+        Json_Value cursor;
+        Json_Value followed_at;
+        Json_Value user_id;
+        Json_Value user_login;
+        while(!done)
+        {
+            if(response.status != 200)
+            {
+                printf("follower page %i failed with %li : %s\n", *page_count, response.status, response.body.c_str());
+                return false;
+            }
+            // pagination is an empty object on the last page. the rest of the page is still walked after the first
+            // old follow, total could come after the data
+            json_read_each(response.body, {{"total", &total_value}, {"pagination.cursor", &cursor}},
+                           "data", {{"followed_at", &followed_at}, {"user_id", &user_id}, {"user_login", &user_login}}, [&]
+            {
+                if(done){
+                    return true;
+                }
+                Follower f;
+                f.followed_at = parse_timestamp(followed_at.view());
+                if(since != 0 && f.followed_at < since)
+                {
+                    done = true;
+                    return true;
+                }
+                f.user_id = user_id.view();
+                f.user_login = user_login.view();
+                out->push_back(std::move(f));
+                return true;
+            });
+            if(*page_count == 1){
+                string_to_int(total_value.view(), total);
+            }
+            if(done || cursor.view().empty()){
+                break;
             }
+            response = helix.call({Helix_Client::Bulk, "GET", url + "&after=" + cursor.string()});
+            (*page_count)++;
         }
-        return nullptr;
+        return true;
     }
-    User* get_user_by_nick(const String& nick)
+
+    // points come from the user file when it has them, caller holds user_file_mutex
+    User* add_known_user(const String_View id, const String_View login)
     {
-        if(nick.empty()){
-            return nullptr;
-        }
-        for(auto& u : users)
+        User u;
+        u.user_id = id;
+        u.user_login = login;
+        if(auto r {user_file.is_open() ? user_file.find(id) : nullptr})
         {
-            if(u.last_known_nick == nick){
-                return &u;
-            }
+            u.points = r->points;
+            u.gamba_points = r->gamba_points;
+            u.social_credit = r->social_credit;
         }
-        return nullptr;
+        return users.add(std::move(u));
     }
 
-    void ban_user(const String& id, const int dur)
+    // caller holds user_file_mutex, and generic_mutex once the bot is running.
+    // a partial fetch isn't persisted, newest_followed_at would move past the follows that are missing
+    void merge_followers(const Vector<Follower>& fetched, const bool persist)
     {
-        std::scoped_lock guard {curl_mutex};
-        curl_easy_reset(curl_handle);
-
-        String url {"https://api.twitch.tv/helix/moderation/bans?broadcaster_id=" + BROADCASTER_ID + "&moderator_id=" + BROADCASTER_ID}; 
-
-        curl_easy_setopt(curl_handle, CURLOPT_URL, url.c_str());
-
-        String user_id {wrap_in_quotes("user_id") + ":" + wrap_in_quotes(id)};
-
-
-        String duration {dur == -1 ? "" : wrap_in_quotes("duration") + ":" + wrap_in_quotes(std::to_string(dur))};
-
-
-        auto list {set_curl_headers(("Authorization: Bearer " + AUTH_TOKEN).c_str(),
-                                    ("Client-Id: " + CLIENT_ID).c_str(),
-                                    "Content-Type: application/json")};
-
-        curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, list);
-
-        String post_fields;
-        if(!duration.empty()){
-            post_fields  = "{\"data\": {" + user_id + "," + duration + "}}";
+        const auto write {persist && user_file.is_open()};
+        for(const auto& f : fetched)
+        {
+            if(!users.get(f.user_id)){
+                add_known_user(f.user_id, f.user_login);
+            }
+            if(write){
+                user_file.set_followed_at(f.user_id, f.followed_at);
+            }
         }
-        else{
-            post_fields  = "{\"data\": {" + user_id + "}}";
+        if(write){
+            user_file.flush();
         }
-        curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, post_fields.c_str());
-
-        curl_easy_perform(curl_handle);
-        curl_slist_free_all(list);
     }
 
-    void subscribe_to_event(const String& s, const int v, const String& c)
-    {
-        std::scoped_lock guard {curl_mutex};
-        curl_easy_reset(curl_handle);
-
-        String url {"https://api.twitch.tv/helix/eventsub/subscriptions"}; 
-
-        auto list {set_curl_headers(("Authorization: Bearer " + AUTH_TOKEN).c_str(),
-                                    ("Client-Id: " + CLIENT_ID).c_str(),
-                                    "Content-Type: application/json")};
-
-        curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, list);
-
-        String post_fields;
-        post_fields = "{" + wrap_in_quotes("type") + ":" + wrap_in_quotes(s) + "," +
-                            wrap_in_quotes("version") + ":" + wrap_in_quotes(std::to_string(v)) + "," +
-                            c + "," + 
-                            wrap_in_quotes("transport") + ":" + "{" + wrap_in_quotes("method") + ":" + wrap_in_quotes("websocket") + "," +
-                                                                      wrap_in_quotes("session_id") + ":" + wrap_in_quotes(event_sub_session_id) +"}}";
-
-        curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, post_fields.c_str());
-
-        auto response {curl_call(url, curl_handle, list)};
-        curl_slist_free_all(list);
-    }
+    // the whole list is fetched again when this long has passed since the last time, even if the counts agree
+    static constexpr s64 full_sync_interval {7 * 24 * 60 * 60};
 
+    // the user file keeps who followed and the newest follow seen, so after the first run only follows newer
+    // than that get fetched. the full list is only fetched again in the background when the follower count
+    // helix reports doesn't match the file or the last full sync is old. runs alongside chat, only the merge holds generic_mutex
     void build_followers_list()
     {
-        std::scoped_lock g {curl_mutex};
-        curl_easy_reset(curl_handle);
-        auto list {set_curl_headers(("Authorization: Bearer " + AUTH_TOKEN).c_str(),
-                                ("Client-Id: " + CLIENT_ID).c_str())};
-        
-        String url {"https://api.twitch.tv/helix/channels/followers?broadcaster_id=" + BROADCASTER_ID + "&first=100"};
-        auto s {curl_call(url, curl_handle, list)};
-        users.reserve(5000);
+        Timer fetch_timer;
+        fetch_timer.start();
+        s64 since {0};
+        {
+            std::scoped_lock f {user_file_mutex};
+            if(open_user_file()){
+                since = user_file.newest_followed_at();
+            }
+        }
 
-        users.push_back({BROADCASTER_ID});
+        Vector<Follower> fetched;
+        int page_count;
+        s64 total;
+        const auto complete {fetch_followers(since, &fetched, &page_count, &total)};
+        printf("fetched %zu %sfollowers in %i pages in %fs%s\n", fetched.size(), since != 0 ? "new " : "", page_count, fetch_timer.elapsed(),
+                                                                  complete ? "" : ", incomplete");
 
-        while(true)
+        Timer merge_timer;
+        merge_timer.start();
+        auto resync {!complete};
         {
-            auto i {s.find("user_id")};
-            if(i != String::npos)
+            std::scoped_lock g {generic_mutex, user_file_mutex};
+            users.reserve(since != 0 ? user_file.size() + fetched.size() : fetched.size() + 1);
+            if(!users.get(BROADCASTER_ID)){
+                add_known_user(BROADCASTER_ID, "");
+            }
+            if(since != 0)
             {
-                users.push_back({});
-                auto& u {users.back()};
-                u.user_id = json_get_value_naive("user_id", s);
-                u.user_login = json_get_value_naive("user_login", s);
-                s.erase(0, s.find("}", i) + 1);
-                if(s.empty()){
-                    break;
+                for(size_t i = 0; i < user_file.size(); i++)
+                {
+                    const auto& r {user_file[i]};
+                    if(r.followed_at != 0 && !users.get(r.user_id)){
+                        add_known_user(r.user_id, "");
+                    }
                 }
             }
-            else
+            merge_followers(fetched, complete);
+            printf("loaded %zu users from %s in %fs\n", users.size(), users_file_name.c_str(), merge_timer.elapsed());
+
+            if(complete && user_file.is_open())
             {
-                auto cursor {json_get_value_naive("cursor", s)};
-                if(!cursor.empty()){
-                    s = curl_call(url + "&after=" + cursor, curl_handle, list);
+                const auto now {(s64)std::time(nullptr)};
+                if(since == 0)
+                {
+                    // that was a full fetch already
+                    user_file.set_last_full_sync(now);
+                    user_file.flush();
                 }
-                else{
-                    break;
+                else
+                {
+                    const auto known {user_file.follower_count()};
+                    resync = (total >= 0 && (size_t)total != known) || now - user_file.last_full_sync() >= full_sync_interval;
+                    printf("helix reports %lli followers, %zu known%s\n", (long long)total, known, resync ? ", resyncing" : "");
                 }
             }
         }
-        curl_slist_free_all(list);
 
-        if(users.empty()){
-            return;
+        if(resync)
+        {
+            std::thread([this]{
+                resync_followers();
+            }).detach();
         }
+    }
 
-        const auto file {"followers.txt"};
+    // full fetch while the bot runs, picks up anything the incremental sync
+    // missed and clears followed_at for whoever unfollowed while the bot was off
+    void resync_followers()
+    {
+        Timer t;
+        t.start();
+        Vector<Follower> fetched;
+        int page_count;
+        s64 total;
+        // anyone past a failed page would look like they unfollowed
+        if(!fetch_followers(0, &fetched, &page_count, &total))
+        {
+            printf("follower resync stopped after %i pages\n", page_count);
+            return;
+        }
+        // a 200 with nothing in it is still more likely a token without the scope than nobody following
+        if(fetched.empty()){
+            return;
+        }
 
-        Vector<User> temp_users;
+        std::unordered_set<String_View> following;
+        following.reserve(fetched.size());
+        for(const auto& f : fetched){
+            following.insert(f.user_id);
+        }
 
-        String line;
-        String tag;
-        String value;
+        std::scoped_lock g {generic_mutex, user_file_mutex};
+        merge_followers(fetched, true);
+        size_t unfollowed {0};
+        if(user_file.is_open())
         {
+            for(size_t i = 0; i < user_file.size(); i++)
             {
-                std::ifstream o {file};
-                User* current {nullptr};
-                while(std::getline(o, line))
+                auto& r {user_file[i]};
+                if(r.followed_at != 0 && !following.count(r.user_id))
                 {
-                    clean_line(&line);
-                    if(line != "End")
-                    {
-                        if(!line.empty())
-                        {
-                            extract_tag_and_value_from_line(line, &tag, &value);
-                            if(tag == "User")
-                            {
-                                temp_users.push_back({});
-                                current = &temp_users.back();
-                                current->user_id = value;
-                            }
-                            else if(tag == "Points"){
-                                current->points = string_to_int(value);
-                            }
-                            else if(tag == "Gamba_Points"){
-                                current->gamba_points = string_to_int(value);
-                            }
-                            else if(tag == "Social_Credit"){
-                                current->social_credit = string_to_int(value);
-                            }
-                        }
-                    }
+                    r.followed_at = 0;
+                    unfollowed++;
                 }
             }
-            std::ofstream f {file};
-            for(auto& u : users)
-            {
-                User* data {nullptr};
-                for(auto& j : temp_users)
-                {
-                    if(u.user_id == j.user_id)
-                    {
-                        u = j;
-                        break;
-                    }
-                }
-                u.serialize_out(&f);
+            user_file.set_last_full_sync(std::time(nullptr));
+            user_file.flush();
+        }
+        printf("resynced %zu followers in %i pages in %fs, %zu unfollowed\n", fetched.size(), page_count, t.elapsed(), unfollowed);
+    }
+
+    // followers.txt and its journal are converted the first time, after that only the binary file is read
+    bool open_user_file()
+    {
+        const auto convert {!Files::exists(users_file_name) && Files::exists(followers_file_name)};
+        if(!user_file.open(users_file_name)){
+            return false;
+        }
+        if(convert)
+        {
+            Vector<User> legacy;
+            load_users_file(followers_file_name, &legacy);
+            load_users_file(followers_journal_file_name, &legacy);
+            for(const auto& u : legacy){
+                user_file.put(u.user_id, u.points, u.gamba_points, u.social_credit);
             }
+            user_file.flush();
+            printf("converted %zu records from %s to %s\n", legacy.size(), followers_file_name.c_str(), users_file_name.c_str());
         }
+        return true;
     }
     
     void serialize_in()
@@ -1016,15 +1475,14 @@ struct Bot
                 if(!line.empty())
                 {
                     extract_tag_and_value_from_line(line, &tag, &value);
-                    if(tag == "BatChest_Count")
-                    {
-                        std::stringstream ss {value};
-                        ss>>batchest_count;
+                    if(tag == "BatChest_Count"){
+                        string_to_int(value, &batchest_count);
                     }
-                    else if(tag == "Gottem_Count")
-                    {
-                        std::stringstream ss {value};
-                        ss>>gottem_count;
+                    else if(tag == "Gottem_Count"){
+                        string_to_int(value, &gottem_count);
+                    }
+                    else if(tag == "Messages_Per_Tick"){
+                        string_to_int(value, &messages_per_tick);
                     }
                 }
             }
@@ -1035,133 +1493,238 @@ struct Bot
             file>>video;
         }
 
+        saved_batchest_count = batchest_count;
+        saved_gottem_count = gottem_count;
+        saved_messages_per_tick = messages_per_tick;
+        saved_video = video;
+
+        load_banned_words();
+        youtube_cache.load();
+
         {
-            std::ifstream file {"banned_words.txt"};
-            Pair<String, int> p;
-            while(file>>p.first>>p.second){
-                banned_words.push_back(p);
+            std::ifstream file {already_followed};
+            while(std::getline(file, line))
+            {
+                clean_line(&line);
+                already_thanks_for_the_follow.push_back(line);
             }
+            saved_follow_count = already_thanks_for_the_follow.size();
         }
 
         {
-            std::ifstream file {already_followed};
+            std::ifstream file {"periodic_messages.txt"};
             while(std::getline(file, line))
             {
                 clean_line(&line);
-                already_thanks_for_the_follow.push_back(line);
+                if(!line.empty()){
+                    periodic_messages.push_back(line);
+                }
             }
         }
+    
+    }
+
+    // decodes every file in sounds/, get_sound finds nothing until this is done
+    void load_sounds()
+    {
+        Timer load_timer;
+        load_timer.start();
 
+        const String directory {"sounds/"};
+        String file_name;
+
+        Vector<Pair<String, String>> path_and_name;
+        path_and_name.reserve(200);
+
+        for(const auto& e : Files::directory_iterator(directory))
         {
-            printf("loading sounds\n");
-            const String directory {"sounds/"};
-            String file_name;
+            file_name = e.path().filename().string(); 
 
-            Vector<Pair<String, String>> path_and_name;
-            path_and_name.reserve(200);
+            path_and_name.push_back({directory + file_name, e.path().filename().stem().string()});
+        }
 
-            for(const auto& e : Files::directory_iterator(directory))
-            {
-                file_name = e.path().filename().string(); 
+        sounds.resize(path_and_name.size());
 
-                path_and_name.push_back({directory + file_name, e.path().filename().stem().string()});
+        auto sound_counter {0};
+        auto load_sound {[&](const Pair<String, String>* data, const int start, const int end)
+        {
+            for(int i = start; i < end; i++)
+            {
+                const auto& d {data[i]};
+                auto chunk {Mix_LoadWAV(d.first.c_str())};
+                sound_counter++;
+                auto& s {sounds[i]};
+                s.name = d.second;
+                s.chunk = chunk;
             }
+        }};
 
-            sounds.resize(path_and_name.size());
+        const int data_to_handle {25};
+        auto number_of_threads {path_and_name.size() / data_to_handle};
+        const auto rem {path_and_name.size() % data_to_handle};
 
-            auto sound_counter {0};
-            auto load_sound {[&](const Pair<String, String>* data, const int start, const int end)
-            {
-                for(int i = start; i < end; i++)
-                {
-                    const auto& d {data[i]};
-                    auto chunk {Mix_LoadWAV(d.first.c_str())};
-                    sound_counter++;
-                    auto& s {sounds[i]};
-                    s.name = d.second;
-                    s.chunk = chunk;
-                }
-            }};
+        if(number_of_threads < 1){
+            number_of_threads = 1;
+        }
+        if(rem != 0){
+            number_of_threads++;
+        }
 
-            const int data_to_handle {25};
-            auto number_of_threads {path_and_name.size() / data_to_handle};
-            const auto rem {path_and_name.size() % data_to_handle};
+        Vector<std::thread> threads(number_of_threads);
+        for(int i = 0; i < threads.size(); i++)
+        {
+            auto start {i * data_to_handle};
 
-            if(number_of_threads < 1){
-                number_of_threads = 1;
+            int end {start + data_to_handle};
+            if(end > path_and_name.size()){
+                end = path_and_name.size();
             }
-            if(rem != 0){
-                number_of_threads++;
+            threads[i] = std::thread(load_sound, path_and_name.data(), start, end);
+        }
+        for(auto& t : threads){
+            t.join();
+        }
+        if(sound_counter != path_and_name.size())
+        {
+            printf("big problem lil bro %i %llu\n", sound_counter, path_and_name.size());
+            assert(false);
+        }
+        sounds_loaded.store(true, std::memory_order_release);
+        printf("loaded %zu sounds in %fs\n", sounds.size(), load_timer.elapsed());
+    }
+
+    // builds the matcher off to the side and swaps it in, chat keeps using the old one until then
+    void load_banned_words()
+    {
+        Vector<Pair<String, int>> words;
+        {
+            std::ifstream file {banned_words_file_name};
+            Pair<String, int> p;
+            while(file>>p.first>>p.second){
+                words.push_back(p);
             }
+        }
+        std::shared_ptr<const Banned_Word_Matcher> matcher {std::make_shared<Banned_Word_Matcher>(words)};
+        std::atomic_store(&banned_words, matcher);
 
-            Vector<std::thread> threads(number_of_threads);
-            for(int i = 0; i < threads.size(); i++)
-            {
-                auto start {i * data_to_handle};
+        std::error_code ec;
+        banned_words_write_time = Files::last_write_time(banned_words_file_name, ec);
+    }
 
-                int end {start + data_to_handle};
-                if(end > path_and_name.size()){
-                    end = path_and_name.size();
-                }
-                threads[i] = std::thread(load_sound, path_and_name.data(), start, end);
+    void check_banned_words_file()
+    {
+        std::error_code ec;
+        const auto t {Files::last_write_time(banned_words_file_name, ec)};
+        if(!ec && t != banned_words_write_time)
+        {
+            load_banned_words();
+            printf("reloaded %s\n", banned_words_file_name.c_str());
+        }
+    }
+
+    // only grabs what changed while holding generic_mutex, the writing happens on the save thread
+    void save_data()
+    {
+        Save_Snapshot snapshot;
+        {
+            std::scoped_lock g {generic_mutex};
+            snapshot.users = users.take_dirty();
+
+            for(auto i = saved_follow_count; i < already_thanks_for_the_follow.size(); i++){
+                snapshot.new_follows.push_back(already_thanks_for_the_follow[i]);
             }
-            for(auto& t : threads){
-                t.join();
+            saved_follow_count = already_thanks_for_the_follow.size();
+
+            if(batchest_count != saved_batchest_count || gottem_count != saved_gottem_count || messages_per_tick != saved_messages_per_tick)
+            {
+                std::stringstream file;
+                file<<"BatChest_Count : "<<batchest_count<<"\n\n";
+                file<<"Gottem_Count : "<<gottem_count<<"\n\n";
+                file<<"Messages_Per_Tick : "<<messages_per_tick<<"\n\n";
+                snapshot.counters = file.str();
+
+                saved_batchest_count = batchest_count;
+                saved_gottem_count = gottem_count;
+                saved_messages_per_tick = messages_per_tick;
             }
-            if(sound_counter != path_and_name.size())
+
+            if(!video.empty() && video != saved_video)
             {
-                printf("big problem lil bro %i %llu\n", sound_counter, path_and_name.size());
-                assert(false);
+                snapshot.video = video;
+                saved_video = video;
             }
-            printf("finished loading sounds\n");
+        }
+
+        if(snapshot.users.empty() && snapshot.new_follows.empty() && snapshot.counters.empty() && snapshot.video.empty()){
+            return;
         }
 
         {
-            std::ifstream file {"periodic_messages.txt"};
-            while(std::getline(file, line))
-            {
-                clean_line(&line);
-                if(!line.empty()){
-                    periodic_messages.push_back(line);
-                }
+            std::scoped_lock g {save_mutex};
+            auto& p {pending_save};
+            for(auto& u : snapshot.users){
+                p.users.push_back(std::move(u));
+            }
+            for(auto& f : snapshot.new_follows){
+                p.new_follows.push_back(std::move(f));
+            }
+            if(!snapshot.counters.empty()){
+                p.counters = std::move(snapshot.counters);
+            }
+            if(!snapshot.video.empty()){
+                p.video = std::move(snapshot.video);
             }
         }
-    
+        save_event.notify();
     }
 
-    void save_data()
+    // save thread only
+    void write_pending_save()
     {
-        std::scoped_lock g {generic_mutex};
+        Save_Snapshot s;
         {
-            std::ofstream file {already_followed};
-            for(auto& u : already_thanks_for_the_follow){
-                file<<u<<"\n";
+            std::scoped_lock g {save_mutex};
+            std::swap(s, pending_save);
+        }
+
+        if(!s.users.empty())
+        {
+            std::scoped_lock g {user_file_mutex};
+            if(user_file.is_open())
+            {
+                for(const auto& u : s.users){
+                    user_file.put(u.user_id, u.points, u.gamba_points, u.social_credit);
+                }
+                user_file.flush();
             }
         }
 
+        if(!s.new_follows.empty())
         {
-            std::ofstream file {"followers.txt"};
-            for(auto& u : users){
-                u.serialize_out(&file);
+            std::ofstream file {already_followed, std::ios::app};
+            for(auto& u : s.new_follows){
+                file<<u<<"\n";
             }
         }
 
+        if(!s.counters.empty())
         {
             std::ofstream file {data_file_name};
-            file<<"BatChest_Count : "<<batchest_count<<"\n\n";
-            file<<"Gottem_Count : "<<gottem_count<<"\n\n";
+            file<<s.counters;
         }
+
+        if(!s.video.empty())
         {
-            if(!video.empty())
-            {
-                std::ofstream file {"video.txt"};
-                file<<video;
-            }
+            std::ofstream file {"video.txt"};
+            file<<s.video;
         }
     }
 
     void quit()
     {
+        if(!sounds_loaded){
+            return;
+        }
         for(auto& s : sounds)
         {
             if(s.chunk){
@@ -1183,7 +1746,10 @@ struct Bot
     std::thread music_thread;
 
     Vector<Command> commands;
-    Vector<String> messages_to_send;
+    Vector<Command_Slot> command_table;
+    Worker_Pool workers {8};
+    Helix_Client helix {&curl_pool, 4};
+    Ring_Queue<String> messages_to_send;
 
     u64 batchest_count {0};
     u64 gottem_count   {0};
@@ -1208,20 +1774,55 @@ struct Bot
     Vector<Voice> voices;
 
     Vector<Sound> sounds;
-    Vector<Sound_To_Play> sounds_to_play;
-    Vector<Sound_To_Play> tts_sounds_to_play_elevated;
+    std::atomic<bool> sounds_loaded {false};
+    Ring_Queue<Sound_To_Play> sounds_to_play;
+    Ring_Queue<Sound_To_Play> tts_sounds_to_play_elevated;
     Vector<String> already_thanks_for_the_follow;
 
     Vector<Sound_Effect> sound_effects;
 
     //std::string music_file;
     Music_Info last_song;
-    Vector<Music_Info> music_queue;
-    Vector<Pair<String, int>> banned_words;
-    Vector<User> users;
+    Ring_Queue<Music_Info> music_queue;
+    // titles and lengths don't change, a week keeps the view and like counts roughly current
+    Youtube_Cache youtube_cache {"youtube_cache.txt", 7 * 24 * 60 * 60};
+    std::shared_ptr<const Banned_Word_Matcher> banned_words;
+    Files::file_time_type banned_words_write_time;
+
+    struct Save_Snapshot
+    {
+        Vector<User> users;
+        Vector<String> new_follows;
+        String counters;
+        String video;
+    };
 
-    Vector<Parsed_Message> priv_messages;
-    Vector<String> ping_messages;
+    Save_Snapshot pending_save;
+    std::mutex save_mutex;
+    Event save_event;
+
+    // what's already on disk, only touched under generic_mutex
+    size_t saved_follow_count {0};
+    u64 saved_batchest_count {0};
+    u64 saved_gottem_count {0};
+    size_t saved_messages_per_tick {0};
+    String saved_video;
+
+    // the save thread writes points, the follower resync writes followed_at
+    User_File user_file;
+    std::mutex user_file_mutex;
+    User_Store users;
+
+    Ring_Queue<String> event_sub_messages;
+    Ring_Queue<Parsed_Message> priv_messages;
+    Ring_Queue<String> ping_messages;
+
+    // 0 means no limit, otherwise the most chat messages handled while holding generic_mutex
+    size_t messages_per_tick {256};
+    std::atomic<size_t> backlog_depth {0};
+    std::atomic<size_t> peak_backlog_depth {0};
+    std::atomic<u64> messages_handled {0};
+    Stamp start_stamp {Clock::now()};
 
     Vector<String> periodic_messages;
 
@@ -1230,12 +1831,21 @@ struct Bot
 
     String already_followed {"already_followed.txt"};
     String data_file_name   {"bot.txt"};
+    String users_file_name {"followers.bin"};
+    // the old text format, only read to convert it
+    String followers_file_name {"followers.txt"};
+    String followers_journal_file_name {"followers_journal.txt"};
+    String banned_words_file_name {"banned_words.txt"};
 
     std::mutex generic_mutex;
     std::mutex sound_mutex;
     std::mutex music_mutex;
     std::mutex send_mutex;
-    std::mutex curl_mutex;
+
+    Event message_event;
+    Event sound_event;
+    Event music_event;
+    Event send_event;
 
     Mix_Music* current_music {nullptr};
 };
@@ -1261,8 +1871,15 @@ void vanish_callback(Bot* b, const String& id, const Vector<String>& args)
     if(args.size() == 1){
         b->ban_user(id, -1);
     }
-    else{
-        b->ban_user(id, string_to_int(args[1]));
+    else
+    {
+        int duration;
+        if(!string_to_int(args[1], &duration) || duration < 1){
+            b->add_message(format_reply(args[0], "invalid duration"));
+        }
+        else{
+            b->ban_user(id, duration);
+        }
     }
 }
 
@@ -1278,7 +1895,7 @@ void bully_callback(Bot* bot, const String& id, const Vector<String>& args)
     auto b {bot->get_user_by_nick(args[1])};
     if(a && b)
     {
-        if(a->last_known_badges.empty() && b->last_known_badges.empty()){
+        if(a->last_known_badges == 0 && b->last_known_badges == 0){
             return;
         }
 
@@ -1289,11 +1906,15 @@ void bully_callback(Bot* bot, const String& id, const Vector<String>& args)
             bot->add_message(format_send("@" + args[1] + " slapped " + "@" + args[0]));
         }
 
-        std::scoped_lock gg {bot->sound_mutex};
         Bot::Sound_To_Play s;
         s.sound = bot->get_sound("spank");
-        s.play();
-        bot->tts_sounds_to_play_elevated.push_back(s);
+        if(s.sound)
+        {
+            std::scoped_lock gg {bot->sound_mutex};
+            s.play();
+            bot->tts_sounds_to_play_elevated.push_back(s);
+            bot->sound_event.notify();
+        }
     }
     else{
         return;
@@ -1311,8 +1932,8 @@ void gamba_give_callback(Bot* b, const String& id, const Vector<String>& args)
         auto u {b->get_user(id)};
         if(u)
         {
-            auto q {string_to_int(args[1])};
-            if(q < 0){
+            s64 q;
+            if(!string_to_int(args[1], &q) || q < 0){
                 b->add_message(format_reply(args[0], "invalid value"));
             }
             else if(q > u->gamba_points){
@@ -1325,6 +1946,8 @@ void gamba_give_callback(Bot* b, const String& id, const Vector<String>& args)
                 {
                     t->gamba_points += q;
                     u->gamba_points -= q;
+                    b->users.touch(t);
+                    b->users.touch(u);
                     b->add_message(format_reply(args[0], "you gave " + std::to_string(q) + " " + args[2]));
                 }
             }
@@ -1332,6 +1955,42 @@ void gamba_give_callback(Bot* b, const String& id, const Vector<String>& args)
     }
 }
 
+void gamba_bless_the_poor(Bot* b, User* u, const String& nick)
+{
+    if(u->gamba_points <= 0)
+    {
+        u->gamba_points = 500;
+        b->users.touch(u);
+        b->add_message(format_reply(nick, "noob since you're so poor the gods have blessed you with 500 points GAMBAADDICT"));
+    }
+}
+
+void gamba_roll(Bot* b, const String& id, const String& nick, const s64 points, const int reward_factor)
+{
+    std::scoped_lock g {b->generic_mutex};
+    auto u {b->get_user(id)};
+    if(u)
+    {
+        // the points could have been spent while the dice were rolling
+        if(u->gamba_points < points){
+            b->add_message(format_reply(nick, "not enough points"));
+        }
+        else if(roll_dice(50))
+        {
+            u->gamba_points += points * reward_factor;
+            b->users.touch(u);
+            b->add_message(format_reply(nick, "you won " + std::to_string(points * reward_factor) + " GAMBA you have " + std::to_string(u->gamba_points) + " points!"));
+        }
+        else
+        {
+            u->gamba_points -= points;
+            b->users.touch(u);
+            b->add_message(format_reply(nick, "you lost " + std::to_string(points) + " pepeLost noob you have " + std::to_string(u->gamba_points) + " points!"));
+        }
+        gamba_bless_the_poor(b, u, nick);
+    }
+}
+
 void gamba_callback(Bot* b, const String& id, const Vector<String>& args)
 {
     std::scoped_lock g {b->generic_mutex};
@@ -1343,7 +2002,7 @@ void gamba_callback(Bot* b, const String& id, const Vector<String>& args)
         }
         else
         {
-            s64 points;
+            s64 points {0};
             auto reward_factor {1};
             if(args[1] == "all")
             {
@@ -1355,8 +2014,10 @@ void gamba_callback(Bot* b, const String& id, const Vector<String>& args)
                 points = u->gamba_points / 2;
                 reward_factor = 5;
             }
-            else{
-                points = string_to_int<s64>(args[1]);
+            else if(!string_to_int(args[1], &points))
+            {
+                b->add_message(format_reply(args[0], "invalid value"));
+                return;
             }
 
             if(points > 0)
@@ -1366,30 +2027,15 @@ void gamba_callback(Bot* b, const String& id, const Vector<String>& args)
                 }
                 else
                 {
-                    auto string_points {std::to_string(points)};
-                    b->add_message(format_reply(args[0], "rolling dice nuts in your mouth GAMBA points at risk is " + string_points));
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-
-                    if(roll_dice(50))
-                    {
-                        u->gamba_points += points * reward_factor;
-                        b->add_message(format_reply(args[0], "you won " + std::to_string(points * reward_factor) + " GAMBA you have " + std::to_string(u->gamba_points) + " points!"));
-                    }
-                    else
-                    {
-                        u->gamba_points -= points;
-                        b->add_message(format_reply(args[0], "you lost " + string_points + " pepeLost noob you have " + std::to_string(u->gamba_points) + " points!"));
-                    }
+                    b->add_message(format_reply(args[0], "rolling dice nuts in your mouth GAMBA points at risk is " + std::to_string(points)));
+                    b->workers.submit_after(1.f, [b, id, nick = args[0], points, reward_factor]{
+                        gamba_roll(b, id, nick, points, reward_factor);
+                    });
+                    return;
                 }
             }
         }
-
-        if(u->gamba_points <= 0)
-        {
-            u->gamba_points = 500;
-            b->add_message(format_reply(args[0], "noob since you're so poor the gods have blessed you with 500 points GAMBAADDICT"));
-        }
-
+        gamba_bless_the_poor(b, u, args[0]);
     }
 }
 
@@ -1484,7 +2130,6 @@ void tts_callback(Bot* b, const String& id, const Vector<String>& args)
 
     Bot::Voice* global_voice {nullptr};
     const auto tts_id {b->TTS_ID_COUNTER};
-    const auto previous_size {b->sounds_to_play.size()};
     b->TTS_ID_COUNTER++;
 
     String msg;
@@ -1498,19 +2143,17 @@ void tts_callback(Bot* b, const String& id, const Vector<String>& args)
 
     auto sound {b->get_tts({}, msg)};
 
-    if(sound.tts){
+    if(sound.tts)
+    {
+        sound.tts_id = tts_id;
         b->sounds_to_play.push_back(sound);
     }
-
-    for(int i = previous_size; i < b->sounds_to_play.size(); i++){
-        b->sounds_to_play[i].tts_id = tts_id;
-    }
+    b->sound_event.notify();
 }
 
 void music_callback(Bot* b, const String& id, const Vector<String>& args)
 {
     auto video_link {args[1]};
-    std::scoped_lock guard {b->curl_mutex};
 
     {
         String s {"app=desktop&v"};
@@ -1557,14 +2200,18 @@ void music_callback(Bot* b, const String& id, const Vector<String>& args)
     auto video       {video_link.substr(equals + 1, String::npos)}; 
     String video_arg {"&id=" + video};
     String key_arg   {"&key=" + YOUTUBE_API_KEY};
-    String api       {"https://www.googleapis.com/youtube/v3/videos?"};
+    String api       {YOUTUBE_URL + "/videos?"};
     String part      {"part=snippet,contentDetails,statistics"};
 
-    curl_easy_reset(curl_handle);
-
-    auto curl_result {curl_call(api + part + video_arg + key_arg, curl_handle)};
-
-    auto yt_video {parse_youtube_api_result(curl_result)};
+    Youtube_Video_Info yt_video;
+    if(!b->youtube_cache.get(video, &yt_video))
+    {
+        auto curl_result {curl_call(api + part + video_arg + key_arg, curl_pool.acquire())};
+        yt_video = parse_youtube_api_result(curl_result);
+        if(!yt_video.title.empty()){
+            b->youtube_cache.put(video, yt_video);
+        }
+    }
 
     if(yt_video.duration > 600)
     {
@@ -1591,6 +2238,7 @@ void music_callback(Bot* b, const String& id, const Vector<String>& args)
     std::scoped_lock g {b->music_mutex};
 
     b->music_queue.push_back({yt_video, video_link, args});
+    b->music_event.notify();
 }
 
 void skip_song_callback(Bot* b, const String& id, const Vector<String>& args)
@@ -1606,6 +2254,7 @@ void skip_song_callback(Bot* b, const String& id, const Vector<String>& args)
             b->last_song = {};
             Mix_FreeMusic(b->current_music);
             b->current_music = nullptr;
+            b->music_event.notify();
         }
         else{
             b->add_message(format_reply(args[0], "Clueless can't skip other people's songs"));
@@ -1622,11 +2271,12 @@ void skip_sound_callback(Bot* b, const String& id, const Vector<String>& args)
         while(b->sounds_to_play.front().tts_id == id)
         {
             Mix_HaltChannel(b->sounds_to_play.front().channel);
-            b->sounds_to_play.erase(b->sounds_to_play.begin());
+            b->sounds_to_play.pop_front();
             if(b->sounds_to_play.empty()){
                 break;
             }
         }
+        b->sound_event.notify();
     }
 }
 
@@ -1658,6 +2308,32 @@ void gottem_callback(Bot* b, const String& id, const Vector<String>& args)
     b->add_message(format_reply(args[0], "We have gotted : " + std::to_string(b->gottem_count)));
 }
 
+void stats_callback(Bot* b, const String& id, const Vector<String>& args)
+{
+    Duration uptime {Clock::now() - b->start_stamp};
+    const auto handled {b->messages_handled.load()};
+    const auto rate {uptime.count() > 0 ? handled / uptime.count() : 0.f};
+    const auto transfers {curl_stats.transfers.load()};
+    const auto connections {curl_stats.new_connections.load()};
+    const auto handshake_ms {connections > 0 ? curl_stats.handshake_us.load() / 1000.f / connections : 0.f};
+    b->add_message(format_reply(args[0], "Backlog : " + std::to_string(b->backlog_depth) +
+                                         " Peak : " + std::to_string(b->peak_backlog_depth) +
+                                         " Handled : " + std::to_string(handled) +
+                                         " (" + std::to_string(rate) + "/s)" +
+                                         " Queue peaks : chat " + std::to_string(b->handle->messages.high_water_mark()) +
+                                         " send " + std::to_string(b->messages_to_send.high_water_mark()) +
+                                         " sounds " + std::to_string(b->sounds_to_play.high_water_mark()) +
+                                         " Workers queued : " + std::to_string(b->workers.queue_depth()) +
+                                         " peak " + std::to_string(b->workers.high_water_mark()) +
+                                         " Helix queued : " + std::to_string(b->helix.queue_depth()) +
+                                         " Youtube cache : " + std::to_string(b->youtube_cache.hits.load()) + "/" +
+                                         std::to_string(b->youtube_cache.lookups.load()) +
+                                         " (" + std::to_string(b->youtube_cache.hit_ratio()) + "%)" +
+                                         " Http : " + std::to_string(transfers) + " calls " +
+                                         std::to_string(connections) + " new connections" +
+                                         " (" + std::to_string(handshake_ms) + "ms each)"));
+}
+
 void today_callback(Bot* b, const String& id, const Vector<String>& args)
 {
     std::scoped_lock g {b->generic_mutex};
@@ -1691,30 +2367,16 @@ void set_video_callback(Bot* b, const String& id, const Vector<String>& args)
 
 void set_title_callback(Bot* b, const String& id, const Vector<String>& args)
 {
-    std::scoped_lock guard {b->curl_mutex};
-    curl_easy_reset(curl_handle);
+    String url {HELIX_URL + "/channels?broadcaster_id=" + BROADCASTER_ID}; 
 
-    String url {"https://api.twitch.tv/helix/channels?broadcaster_id=" + BROADCASTER_ID}; 
-
-    curl_easy_setopt(curl_handle, CURLOPT_URL, url.c_str());
-
-    auto list {set_curl_headers(("Authorization: Bearer " + AUTH_TOKEN).c_str(),
-                                ("Client-Id: " + CLIENT_ID).c_str(),
-                                 "Content-Type: application/json")};
-
-    curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, list);
-
-    String post_fields;
     String title;
 
     for(int i = 1; i < args.size(); i++){
         title += args[i] + ' ';
     }
-    post_fields  = "{" + wrap_in_quotes("title") + ":" + wrap_in_quotes(title) + "}";
-    curl_easy_setopt(curl_handle, CURLOPT_CUSTOMREQUEST, "PATCH");
-    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, post_fields.c_str());
-    curl_easy_perform(curl_handle);
-    curl_slist_free_all(list);
+    Json_Writer body;
+    body.object().string("title", title);
+    b->helix.call({Helix_Client::Normal, "PATCH", url, body.text()});
     b->add_message(format_send("Stream Title : " + title));
 }
 
@@ -1740,6 +2402,9 @@ void sub_callback(Bot* b, const String& id, const Vector<String>& args)
 
 void start_bot(Bot* _bot, int args, const char** argc)
 {
+    Timer startup_timer;
+    startup_timer.start();
+
     BROADCASTER_NAME = argc[1];
 
     BOT_NAME = argc[2];
@@ -1752,20 +2417,21 @@ void start_bot(Bot* _bot, int args, const char** argc)
         file>>YOUTUBE_API_KEY;
         file>>TIKTOK_SESSION_ID;
     }
+    bot.helix.set_credentials(CLIENT_ID, AUTH_TOKEN);
+    load_endpoints("endpoints.txt");
 
+    bot.experimental = false;
     {
-        curl_easy_reset(curl_handle);
-        auto list {set_curl_headers(("Authorization: Bearer " + AUTH_TOKEN).c_str(),
-                                    ("Client-Id: " + CLIENT_ID).c_str())};
-
-        String s {curl_call(("https://api.twitch.tv/helix/users?login=" + BROADCASTER_NAME).c_str(), curl_handle, list)};
-        BROADCASTER_ID = json_get_value_naive("id", s);
-        curl_slist_free_all(list);
+        Timer t;
+        t.start();
+        bot.serialize_in();
+        printf("read saved data in %fs\n", t.elapsed());
     }
 
-
-    bot.experimental = false;
-    bot.serialize_in();
+    // nothing else needs the sounds, get_sound comes up empty until they're in
+    std::thread([](Bot* b){
+        b->load_sounds();
+    }, &bot).detach();
 
     bot.voices = {{"brian", Bot::Voice::Stream_Elements},
                   {"filiz", Bot::Voice::Stream_Elements},
@@ -1818,7 +2484,7 @@ void start_bot(Bot* _bot, int args, const char** argc)
     //}});
 
     bot.add_command("commands", commands_callback); 
-    bot.add_command("toggle_command", toggle_command_callback, {moderator_badge, broadcaster_badge}); 
+    bot.add_command("toggle_command", toggle_command_callback, moderator_badge | broadcaster_badge); 
     bot.add_command("stack", stack_callback); 
     bot.add_command("drop", drop_callback); 
     bot.add_command("discord", discord_callback); 
@@ -1840,28 +2506,50 @@ void start_bot(Bot* _bot, int args, const char** argc)
     bot.add_command("sr", music_callback); 
     bot.add_command("skip", skip_song_callback); 
     bot.add_command("sc", music_count_callback); 
-    bot.add_command("ss", skip_sound_callback, {broadcaster_badge, vip_badge, moderator_badge});
+    bot.add_command("ss", skip_sound_callback, broadcaster_badge | vip_badge | moderator_badge);
     bot.add_command("song", song_callback); 
     bot.add_command("bot", bot_callback); 
     bot.add_command("batchest", batchest_callback); 
     bot.add_command("gottem", gottem_callback); 
+    bot.add_command("stats", stats_callback, moderator_badge | broadcaster_badge); 
     bot.add_command("today", today_callback); 
     bot.add_command("video", video_callback); 
-    bot.add_command("settoday", set_today_callback, {moderator_badge, broadcaster_badge}); 
-    bot.add_command("setvideo", set_video_callback, {moderator_badge, broadcaster_badge}); 
-    bot.add_command("settitle", set_title_callback, {broadcaster_badge, moderator_badge}); 
-    bot.add_command("founder", founder_callback, {founder_badge}); 
-    bot.add_command("mod", mod_callback, {moderator_badge}); 
-    bot.add_command("sub", sub_callback, {subscriber_badge}); 
-    bot.add_command("pleb", pleb_callback, {}, true); 
+    bot.add_command("settoday", set_today_callback, moderator_badge | broadcaster_badge); 
+    bot.add_command("setvideo", set_video_callback, moderator_badge | broadcaster_badge); 
+    bot.add_command("settitle", set_title_callback, broadcaster_badge | moderator_badge); 
+    bot.add_command("founder", founder_callback, founder_badge); 
+    bot.add_command("mod", mod_callback, moderator_badge); 
+    bot.add_command("sub", sub_callback, subscriber_badge); 
+    bot.add_command("pleb", pleb_callback, 0, true); 
 
     {
         auto tc {bot.find_command("toggle_command")};
         tc->togglable = false;
+
+        auto tts {bot.find_command("tts")};
+        tts->takes_reply_target = true;
+        tts->max_running = 2;
+
+        auto sr {bot.find_command("sr")};
+        sr->max_running = 2;
+    }
+
+    // the lookup and the irc handshake overlap, eventsub waits for the id since subscribing needs it
+    Timer lookup_timer;
+    lookup_timer.start();
+    auto lookup {bot.helix.submit({Helix_Client::Normal, "GET", HELIX_URL + "/users?login=" + BROADCASTER_NAME})};
+
+    bot.connection_id = bot.end_point.connect(IRC_URL, "Twitch IRC", twitch_irc_message_handler, &bot.message_event);
+
+    {
+        const auto body {lookup.get().body};
+        Json_Value id;
+        json_read(body, {{"data.0.id", &id}});
+        BROADCASTER_ID = id.string();
     }
+    printf("looked up broadcaster id in %fs\n", lookup_timer.elapsed());
 
-    bot.connection_id = bot.end_point.connect("wss://irc-ws.chat.twitch.tv:443", "Twitch IRC", twitch_irc_message_handler);
-    bot.event_sub_connection_id = bot.end_point.connect("wss://eventsub.wss.twitch.tv/ws", "Event Sub", event_sub_message_handler);
+    bot.event_sub_connection_id = bot.end_point.connect(EVENT_SUB_URL, "Event Sub", event_sub_message_handler, &bot.message_event);
 
     printf("%i\n", bot.connection_id);
     printf("%i\n", bot.event_sub_connection_id);
@@ -1883,11 +2571,10 @@ void start_bot(Bot* _bot, int args, const char** argc)
         bot.end_point.send(bot.connection_id, "PASS oauth:" + AUTH_TOKEN + "\r\n");
         bot.end_point.send(bot.connection_id, "NICK " + BOT_NAME + "\r\n");
         bot.end_point.send(bot.connection_id, "JOIN #" + BROADCASTER_NAME + "\r\n");
+        printf("sent JOIN after %fs\n", startup_timer.elapsed());
 
         bot.event_sub_handle = bot.end_point.get_metadata(bot.event_sub_connection_id);
 
-        bot.build_followers_list();
-
         std::random_device random_device;
 
         GENERATOR = std::knuth_b {random_device()};
@@ -1896,12 +2583,19 @@ void start_bot(Bot* _bot, int args, const char** argc)
 
         const auto sleep_time {100};
 
+        {
+            static Event* sound_event {&bot.sound_event};
+            Mix_ChannelFinished([](int){
+                sound_event->notify();
+            });
+        }
+
         auto message_thread {std::thread([&](Bot* b)
         {
             while(true)
             {
                 b->check_messages();
-                std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
+                b->wait_for_messages();
             }
         }, &bot)};
         message_thread.detach();
@@ -1911,7 +2605,7 @@ void start_bot(Bot* _bot, int args, const char** argc)
             while(true)
             {
                 b->check_music_queue();
-                std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
+                b->wait_for_music();
             }
         }, &bot)};
         music_thread.detach();
@@ -1921,30 +2615,50 @@ void start_bot(Bot* _bot, int args, const char** argc)
             while(true)
             {
                 b->send_messages();
-                std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
+                b->wait_for_messages_to_send();
             }
         }, &bot)};
         send_thread.detach();
 
+        auto save_thread {std::thread([&](Bot* b)
+        {
+            while(true)
+            {
+                b->save_event.wait();
+                b->write_pending_save();
+            }
+        }, &bot)};
+        save_thread.detach();
+
         auto sound_thread {std::thread([&](Bot* b)
         {
             while(true)
             {
                 b->check_sounds_to_play();
-                std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
+                b->wait_for_sounds();
             }
         }, &bot)};
         sound_thread.detach();
 
+        // chat is served already, followers come in when they come in
+        std::thread([](Bot* b){
+            b->build_followers_list();
+        }, &bot).detach();
+        printf("started chat threads after %fs\n", startup_timer.elapsed());
+
         Timer bot_save_data_timer;
         bot_save_data_timer.start(1.f / 30.f);
 
+        Timer banned_words_timer;
+        banned_words_timer.start(5);
+
         while(running)
         {
             if(!said_welcome_message)
             {
                 if(bot.handle->joined)
                 {
+                    printf("joined irc after %fs\n", startup_timer.elapsed());
                     bot.add_message("PRIVMSG #" + BROADCASTER_NAME + " :lilbro BatChest lilbro\r\n");
                     said_welcome_message = true;
                 }
@@ -1954,6 +2668,11 @@ void start_bot(Bot* _bot, int args, const char** argc)
                 bot.save_data();
                 bot_save_data_timer.start(1.f / 30.f);
             }
+            if(banned_words_timer.is_time())
+            {
+                bot.check_banned_words_file();
+                banned_words_timer.start(5);
+            }
             std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
         }
     }
@@ -1985,12 +2704,13 @@ int main(int args, const char** argc)
     Mix_OpenAudio(44000, MIX_DEFAULT_FORMAT, 2, 4096);
     Mix_AllocateChannels(1000000);
 
-    curl_handle = curl_easy_init();
+    curl_global_init(CURL_GLOBAL_DEFAULT);
 
     start_bot(&bot, args, argc);
     
     bot.quit();
-    curl_easy_cleanup(curl_handle);
+    curl_pool.clear();
+    curl_global_cleanup();
     SDL_Quit();
 
     return 0;
@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+"""Local stand-in for Helix, YouTube and the TTS services so the bot's HTTP paths run offline.
+
+    python3 mock/mock_server.py --port 8080 --latency-ms 40 --jitter-ms 20 --error-rate 0.01
+
+then copy mock/endpoints.txt next to the bot (or merge it into your endpoints.txt).
+Only the standard library is needed. Answers are canned: TTS gets a short generated WAV
+(or --audio FILE), YouTube always finds the same video, Helix has --followers fake followers.
+--error-rate answers that share of requests with a 500, --rate-limit-rate with a Helix style 429.
+Ctrl-C (or SIGTERM) prints request counts and latency percentiles per route.
+"""
+
+import argparse
+import base64
+import io
+import json
+import math
+import random
+import signal
+import struct
+import threading
+import time
+import wave
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+
+def make_wav(seconds=0.5, rate=22050, pitch=440.0):
+    frames = bytearray()
+    for i in range(int(seconds * rate)):
+        frames += struct.pack("<h", int(8000 * math.sin(2 * math.pi * pitch * i / rate)))
+    out = io.BytesIO()
+    with wave.open(out, "wb") as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(rate)
+        w.writeframes(bytes(frames))
+    return out.getvalue()
+
+
+class Bucket:
+    """Helix's points bucket, refilled in full once a minute."""
+
+    def __init__(self, limit=800):
+        self.limit = limit
+        self.remaining = limit
+        self.reset = int(time.time()) + 60
+        self.lock = threading.Lock()
+
+    def spend(self):
+        with self.lock:
+            now = int(time.time())
+            if now >= self.reset:
+                self.remaining = self.limit
+                self.reset = now + 60
+            if self.remaining > 0:
+                self.remaining -= 1
+            return self.remaining, self.reset
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.latencies = {}
+
+    def add(self, route, ms):
+        with self.lock:
+            self.latencies.setdefault(route, []).append(ms)
+
+    def report(self):
+        with self.lock:
+            for route, values in sorted(self.latencies.items()):
+                values.sort()
+                pick = lambda p: values[min(len(values) - 1, int(p * len(values)))]
+                print(f"{route:32} {len(values):7} requests  p50 {pick(0.5):7.1f}ms  p99 {pick(0.99):7.1f}ms  max {values[-1]:7.1f}ms")
+
+
+def make_handler(args, audio, bucket, stats):
+    now = int(time.time())
+    followers = [
+        {
+            "user_id": str(200000 + i),
+            "user_login": f"follower_{i}",
+            "user_name": f"Follower_{i}",
+            "followed_at": time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime(now - i * 3600)),
+        }
+        for i in range(args.followers)
+    ]
+    video = {
+        "kind": "youtube#videoListResponse",
+        "items": [
+            {
+                "id": "dQw4w9WgXcQ",
+                "snippet": {"title": "Mock Song", "channelTitle": "Mock Channel"},
+                "contentDetails": {"duration": "PT3M33S"},
+                "statistics": {"viewCount": "1000000", "likeCount": "50000"},
+            }
+        ],
+    }
+
+    class Handler(BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def log_message(self, *a):
+            if args.verbose:
+                super().log_message(*a)
+
+        def reply(self, status, body=b"", content_type="application/json", headers=()):
+            if isinstance(body, (dict, list)):
+                # pretty printed like google does
+                body = json.dumps(body, indent=2).encode()
+            self.send_response(status)
+            self.send_header("Content-Type", content_type)
+            self.send_header("Content-Length", str(len(body)))
+            for k, v in headers:
+                self.send_header(k, v)
+            self.end_headers()
+            self.wfile.write(body)
+
+        def handle_any(self):
+            start = time.perf_counter()
+            length = int(self.headers.get("Content-Length") or 0)
+            request_body = self.rfile.read(length) if length else b""
+            url = urlparse(self.path)
+            query = parse_qs(url.query)
+            route = self.route(url.path)
+
+            delay = args.latency_ms + random.uniform(0, args.jitter_ms)
+            if delay > 0:
+                time.sleep(delay / 1000)
+
+            helix = route.startswith("helix")
+            rate_headers = ()
+            if helix:
+                remaining, reset = bucket.spend()
+                rate_headers = (("Ratelimit-Limit", str(bucket.limit)), ("Ratelimit-Remaining", str(remaining)), ("Ratelimit-Reset", str(reset)))
+
+            if random.random() < args.error_rate:
+                self.reply(500, {"error": "Internal Server Error", "status": 500})
+            elif helix and random.random() < args.rate_limit_rate:
+                self.reply(429, {"error": "Too Many Requests", "status": 429},
+                           headers=(("Ratelimit-Limit", str(bucket.limit)), ("Ratelimit-Remaining", "0"), ("Ratelimit-Reset", str(int(time.time()) + 1))))
+            else:
+                self.answer(route, query, request_body, rate_headers)
+            stats.add(f"{self.command} {route}", (time.perf_counter() - start) * 1000)
+
+        def route(self, path):
+            for prefix in ("/helix/users", "/helix/channels/followers", "/helix/moderation/bans", "/helix/eventsub/subscriptions", "/helix/channels",
+                           "/youtube/videos", "/streamelements/speech", "/nice_gg/tts", "/tiktok/media/api/text/speech/invoke"):
+                if path.rstrip("/") == prefix:
+                    return prefix[1:]
+            return "unknown"
+
+        def answer(self, route, query, request_body, rate_headers):
+            if route == "helix/users":
+                login = query.get("login", ["broadcaster"])[0]
+                self.reply(200, {"data": [{"id": "100000", "login": login, "display_name": login}]}, headers=rate_headers)
+            elif route == "helix/channels/followers":
+                first = int(query.get("first", ["20"])[0])
+                offset = int(query.get("after", ["0"])[0])
+                page = followers[offset:offset + first]
+                pagination = {"cursor": str(offset + first)} if offset + first < len(followers) else {}
+                self.reply(200, {"total": len(followers), "data": page, "pagination": pagination}, headers=rate_headers)
+            elif route == "helix/moderation/bans":
+                self.reply(200, {"data": [{"broadcaster_id": "100000", "moderator_id": "100000", "created_at": "2023-01-01T00:00:00Z"}]}, headers=rate_headers)
+            elif route == "helix/eventsub/subscriptions":
+                self.reply(202, {"data": [{"id": "mock-subscription", "status": "enabled"}]}, headers=rate_headers)
+            elif route == "helix/channels":
+                self.reply(204, headers=rate_headers)
+            elif route == "youtube/videos":
+                self.reply(200, video)
+            elif route in ("streamelements/speech", "nice_gg/tts"):
+                self.reply(200, audio, content_type="audio/wav")
+            elif route == "tiktok/media/api/text/speech/invoke":
+                self.reply(200, {"data": {"v_str": base64.b64encode(audio).decode()}, "status_code": 0})
+            else:
+                self.reply(404, {"error": "Not Found", "status": 404})
+
+        do_GET = handle_any
+        do_POST = handle_any
+        do_PATCH = handle_any
+
+    return Handler
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--latency-ms", type=float, default=0, help="added to every answer")
+    parser.add_argument("--jitter-ms", type=float, default=0, help="random extra latency up to this much")
+    parser.add_argument("--error-rate", type=float, default=0, help="share of requests answered with a 500")
+    parser.add_argument("--rate-limit-rate", type=float, default=0, help="share of helix requests answered with a 429")
+    parser.add_argument("--followers", type=int, default=250)
+    parser.add_argument("--audio", help="file served for tts instead of the generated wav")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    audio = open(args.audio, "rb").read() if args.audio else make_wav()
+    stats = Stats()
+    server = ThreadingHTTPServer(("127.0.0.1", args.port), make_handler(args, audio, Bucket(), stats))
+    print(f"mock endpoints on http://127.0.0.1:{args.port}", flush=True)
+
+    def stop(*_):
+        raise KeyboardInterrupt
+    signal.signal(signal.SIGINT, stop)
+    signal.signal(signal.SIGTERM, stop)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    stats.report()
+
+
+if __name__ == "__main__":
+    main()
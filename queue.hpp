@@ -0,0 +1,144 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+
+// fifo on top of a power of two ring, pop_front is O(1) instead of shifting a vector.
+// when it fills up the ring doubles rather than dropping, a lost chat reply or song is worse than the copy
+template<typename T>
+struct Ring_Queue
+{
+    Ring_Queue(const size_t initial_capacity = 64)
+    {
+        size_t capacity {1};
+        while(capacity < initial_capacity){
+            capacity <<= 1;
+        }
+        items.resize(capacity);
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    size_t high_water_mark() const
+    {
+        return peak.load(std::memory_order_relaxed);
+    }
+
+    T& front()
+    {
+        return items[head];
+    }
+
+    T& operator[](const size_t i)
+    {
+        return items[(head + i) & (items.size() - 1)];
+    }
+
+    void push_back(T value)
+    {
+        if(count == items.size()){
+            grow();
+        }
+        items[(head + count) & (items.size() - 1)] = std::move(value);
+        count++;
+        if(count > peak.load(std::memory_order_relaxed)){
+            peak.store(count, std::memory_order_relaxed);
+        }
+    }
+
+    void pop_front()
+    {
+        items[head] = T{};
+        head = (head + 1) & (items.size() - 1);
+        count--;
+    }
+
+    void clear()
+    {
+        while(!empty()){
+            pop_front();
+        }
+    }
+
+    private:
+        void grow()
+        {
+            Vector<T> bigger(items.size() * 2);
+            for(size_t i = 0; i < count; i++){
+                bigger[i] = std::move((*this)[i]);
+            }
+            items.swap(bigger);
+            head = 0;
+        }
+
+        Vector<T> items;
+        size_t head  {0};
+        size_t count {0};
+        std::atomic<size_t> peak {0};
+};
+
+// lock free single producer single consumer ring, push only from one thread and pop only from one other thread
+template<typename T, size_t N>
+struct Spsc_Queue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Spsc_Queue size must be a power of two");
+
+    // producer, returns false and leaves value alone when the ring is full
+    bool push(T&& value)
+    {
+        const auto t {tail.load(std::memory_order_relaxed)};
+        const auto h {head.load(std::memory_order_acquire)};
+        if(t - h == N){
+            return false;
+        }
+        items[t & (N - 1)] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+
+        if(t + 1 - h > peak.load(std::memory_order_relaxed)){
+            peak.store(t + 1 - h, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // consumer
+    bool pop(T* out)
+    {
+        const auto h {head.load(std::memory_order_relaxed)};
+        const auto t {tail.load(std::memory_order_acquire)};
+        if(h == t){
+            return false;
+        }
+        *out = std::move(items[h & (N - 1)]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    size_t size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    size_t high_water_mark() const
+    {
+        return peak.load(std::memory_order_relaxed);
+    }
+
+    private:
+        Vector<T> items {Vector<T>(N)};
+        alignas(64) std::atomic<size_t> head {0};
+        alignas(64) std::atomic<size_t> tail {0};
+        std::atomic<size_t> peak {0};
+};
@@ -3,6 +3,9 @@
 #include <string>
 using String = std::string;
 
+#include <string_view>
+using String_View = std::string_view;
+
 #include <vector>
 
 template<typename T>
@@ -10,6 +13,8 @@ using Vector = std::vector<T>;
 
 #include <cstdint>
 using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
 using u64 = std::uint64_t;
 using s64 = std::int64_t;
 using s16 = std::int16_t;
@@ -0,0 +1,405 @@
+#pragma once
+
+#include "types.hpp"
+#include "utilities.hpp"
+#include <cstring>
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// read/write mapping of a whole file, resize remaps so pointers into data don't survive it
+struct Mapped_File
+{
+    u8* data {nullptr};
+    u64 size {0};
+
+    bool open(const String& path)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file == INVALID_HANDLE_VALUE){
+            return false;
+        }
+        LARGE_INTEGER s;
+        if(!GetFileSizeEx(file, &s)){
+            return false;
+        }
+        size = s.QuadPart;
+#else
+        file = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if(file == -1){
+            return false;
+        }
+        struct stat s;
+        if(fstat(file, &s) != 0){
+            return false;
+        }
+        size = s.st_size;
+#endif
+        return size == 0 || map();
+    }
+
+    bool resize(const u64 new_size)
+    {
+        unmap();
+#ifdef _WIN32
+        LARGE_INTEGER s;
+        s.QuadPart = new_size;
+        if(!SetFilePointerEx(file, s, nullptr, FILE_BEGIN) || !SetEndOfFile(file)){
+            return false;
+        }
+#else
+        if(ftruncate(file, new_size) != 0){
+            return false;
+        }
+#endif
+        size = new_size;
+        return map();
+    }
+
+    // asks the os to start writing dirty pages back, doesn't wait for it
+    void flush()
+    {
+        if(!data){
+            return;
+        }
+#ifdef _WIN32
+        FlushViewOfFile(data, 0);
+#else
+        msync(data, size, MS_ASYNC);
+#endif
+    }
+
+    void close()
+    {
+        unmap();
+#ifdef _WIN32
+        if(file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(file);
+            file = INVALID_HANDLE_VALUE;
+        }
+#else
+        if(file != -1)
+        {
+            ::close(file);
+            file = -1;
+        }
+#endif
+    }
+
+    ~Mapped_File()
+    {
+        close();
+    }
+
+    private:
+        bool map()
+        {
+#ifdef _WIN32
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+            if(!mapping){
+                return false;
+            }
+            data = (u8*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+#else
+            auto p {mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0)};
+            data = p == MAP_FAILED ? nullptr : (u8*)p;
+#endif
+            return data != nullptr;
+        }
+
+        void unmap()
+        {
+            if(data)
+            {
+#ifdef _WIN32
+                UnmapViewOfFile(data);
+#else
+                munmap(data, size);
+#endif
+                data = nullptr;
+            }
+#ifdef _WIN32
+            if(mapping)
+            {
+                CloseHandle(mapping);
+                mapping = nullptr;
+            }
+#endif
+        }
+
+#ifdef _WIN32
+        HANDLE file {INVALID_HANDLE_VALUE};
+        HANDLE mapping {nullptr};
+#else
+        int file {-1};
+#endif
+};
+
+struct User_Record
+{
+    char user_id[32];
+    // unix seconds, 0 when not following
+    s64 followed_at;
+    s64 points;
+    s64 gamba_points;
+    s64 social_credit;
+};
+static_assert(sizeof(User_Record) == 64, "User_Record is a fixed size on disk");
+
+struct User_File_Header
+{
+    char magic[4];
+    u32 version;
+    u32 record_size;
+    // slots in the id index, 0 while the index is being rebuilt
+    u32 index_capacity;
+    u64 record_count;
+    u64 record_capacity;
+    // newest followed_at of any sync, follows before it are already in the file
+    s64 newest_followed_at;
+    // unix seconds of the last time the whole follower list was compared, 0 for never
+    s64 last_full_sync;
+    u8 reserved[16];
+};
+static_assert(sizeof(User_File_Header) == 64, "User_File_Header is a fixed size on disk");
+
+// header | record_capacity records | index_capacity u32 slots
+// the index is open addressing on hash_string(user_id), a slot holds record number + 1 and 0 is empty
+struct User_File
+{
+    static constexpr u32 version {2};
+    static constexpr u64 initial_capacity {1024};
+
+    bool open(const String& path)
+    {
+        if(!file.open(path))
+        {
+            printf("couldn't open %s\n", path.c_str());
+            return false;
+        }
+        if(file.size == 0){
+            return create(initial_capacity);
+        }
+        if(file.size < sizeof(User_File_Header) || memcmp(header()->magic, "TBUS", 4) != 0)
+        {
+            printf("%s is not a user file\n", path.c_str());
+            return false;
+        }
+        if(header()->version == 1 && header()->record_size == sizeof(User_Record) && !upgrade_from_version_1())
+        {
+            printf("%s has ids too long for version %u\n", path.c_str(), version);
+            return false;
+        }
+        if(header()->version != version || header()->record_size != sizeof(User_Record))
+        {
+            printf("%s has version %u, expected %u\n", path.c_str(), header()->version, version);
+            return false;
+        }
+        if(file.size < layout_size(header()->record_capacity))
+        {
+            printf("%s is truncated\n", path.c_str());
+            return false;
+        }
+        // a crash in the middle of grow leaves the index half built
+        if(header()->index_capacity == 0){
+            rebuild_index();
+        }
+        return true;
+    }
+
+    bool is_open() const
+    {
+        return file.data != nullptr;
+    }
+
+    size_t size() const
+    {
+        return header()->record_count;
+    }
+
+    User_Record& operator[](const size_t i)
+    {
+        return records()[i];
+    }
+
+    User_Record* find(const String_View id)
+    {
+        const auto mask {header()->index_capacity - 1};
+        auto slot {hash_string(id) & mask};
+        while(true)
+        {
+            const auto r {index()[slot]};
+            if(r == 0){
+                return nullptr;
+            }
+            auto& record {records()[r - 1]};
+            if(id == record.user_id){
+                return &record;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    // overwrites the record in place when the id is already there, appends it otherwise
+    bool put(const String_View id, const s64 points, const s64 gamba_points, const s64 social_credit)
+    {
+        if(id.empty() || id.size() >= sizeof(User_Record::user_id)){
+            return false;
+        }
+        auto r {find(id)};
+        if(!r)
+        {
+            if(header()->record_count == header()->record_capacity && !grow()){
+                return false;
+            }
+            const auto n {header()->record_count};
+            r = &records()[n];
+            memset(r, 0, sizeof(User_Record));
+            memcpy(r->user_id, id.data(), id.size());
+            insert_index(id, n);
+            header()->record_count = n + 1;
+        }
+        r->points = points;
+        r->gamba_points = gamba_points;
+        r->social_credit = social_credit;
+        return true;
+    }
+
+    s64 newest_followed_at() const
+    {
+        return header()->newest_followed_at;
+    }
+
+    s64 last_full_sync() const
+    {
+        return header()->last_full_sync;
+    }
+
+    void set_last_full_sync(const s64 t)
+    {
+        header()->last_full_sync = t;
+    }
+
+    // records with followed_at set
+    size_t follower_count()
+    {
+        size_t count {0};
+        for(u64 i = 0; i < header()->record_count; i++){
+            count += records()[i].followed_at != 0;
+        }
+        return count;
+    }
+
+    // appends a zeroed record if the id is new
+    bool set_followed_at(const String_View id, const s64 followed_at)
+    {
+        if(!find(id) && !put(id, 0, 0, 0)){
+            return false;
+        }
+        find(id)->followed_at = followed_at;
+        if(followed_at > header()->newest_followed_at){
+            header()->newest_followed_at = followed_at;
+        }
+        return true;
+    }
+
+    void flush()
+    {
+        file.flush();
+    }
+
+    private:
+        static u64 layout_size(const u64 record_capacity)
+        {
+            return sizeof(User_File_Header) + record_capacity * sizeof(User_Record) + record_capacity * 2 * sizeof(u32);
+        }
+
+        User_File_Header* header() const
+        {
+            return (User_File_Header*)file.data;
+        }
+
+        User_Record* records() const
+        {
+            return (User_Record*)(file.data + sizeof(User_File_Header));
+        }
+
+        u32* index() const
+        {
+            return (u32*)(file.data + sizeof(User_File_Header) + header()->record_capacity * sizeof(User_Record));
+        }
+
+        bool create(const u64 capacity)
+        {
+            if(!file.resize(layout_size(capacity))){
+                return false;
+            }
+            memset(file.data, 0, file.size);
+            auto h {header()};
+            memcpy(h->magic, "TBUS", 4);
+            h->version = version;
+            h->record_size = sizeof(User_Record);
+            h->record_capacity = capacity;
+            h->index_capacity = capacity * 2;
+            return true;
+        }
+
+        // version 1 had a 40 byte id where user_id and followed_at are now, every id in practice is far
+        // shorter than 32 so the zeroed tail already reads as followed_at 0 and only the version changes
+        bool upgrade_from_version_1()
+        {
+            for(u64 i = 0; i < header()->record_count; i++)
+            {
+                if(records()[i].user_id[sizeof(User_Record::user_id) - 1] != 0){
+                    return false;
+                }
+            }
+            header()->version = version;
+            return true;
+        }
+
+        // the records stay where they are, the index moves past the new records and gets rebuilt
+        bool grow()
+        {
+            const auto capacity {header()->record_capacity * 2};
+            header()->index_capacity = 0;
+            if(!file.resize(layout_size(capacity))){
+                return false;
+            }
+            header()->record_capacity = capacity;
+            rebuild_index();
+            return true;
+        }
+
+        void rebuild_index()
+        {
+            const auto capacity {(u32)(header()->record_capacity * 2)};
+            memset(index(), 0, capacity * sizeof(u32));
+            header()->index_capacity = capacity;
+            for(u64 i = 0; i < header()->record_count; i++){
+                insert_index(records()[i].user_id, i);
+            }
+        }
+
+        void insert_index(const String_View id, const u64 record)
+        {
+            const auto mask {header()->index_capacity - 1};
+            auto slot {hash_string(id) & mask};
+            while(index()[slot] != 0){
+                slot = (slot + 1) & mask;
+            }
+            index()[slot] = (u32)(record + 1);
+        }
+
+        Mapped_File file;
+};
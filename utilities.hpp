@@ -1,6 +1,12 @@
 #pragma once
 #include "types.hpp"
-#include <sstream>
+#include <charconv>
+#include <mutex>
+#include <condition_variable>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 struct Timer
 {
@@ -36,8 +42,72 @@ struct Timer
         }
         return false;
     }
+
+    float time_left()
+    {
+        if(!started){
+            return 0;
+        }
+        Duration elapsed {Clock::now() - begin};
+        return wait - elapsed.count();
+    }
+
+    float elapsed()
+    {
+        Duration e {Clock::now() - begin};
+        return e.count();
+    }
+};
+
+// auto reset event, a notify that happens while nobody is waiting is not lost
+struct Event
+{
+    std::mutex mutex;
+    std::condition_variable condition_variable;
+    bool signaled {false};
+
+    void notify()
+    {
+        {
+            std::scoped_lock l {mutex};
+            signaled = true;
+        }
+        condition_variable.notify_one();
+    }
+
+    void wait()
+    {
+        std::unique_lock l {mutex};
+        condition_variable.wait(l, [&]{
+            return signaled;
+        });
+        signaled = false;
+    }
+
+    // returns false if the time ran out before a notify
+    bool wait(const float seconds)
+    {
+        std::unique_lock l {mutex};
+        auto result {condition_variable.wait_for(l, Duration{seconds}, [&]{
+            return signaled;
+        })};
+        signaled = false;
+        return result;
+    }
 };
 
+// index of the lowest set bit, x can't be 0
+inline int trailing_zeros(const u64 x)
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return (int)i;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
 inline void string_erase(String* str, const char c)
 {
     auto f {str->find(c)};
@@ -106,27 +176,27 @@ inline void extract_tag_and_value_from_line(String s, String* tag, String* value
     clean_line(value);
 }
 
-inline Vector<String> tokenize(const String& str)
+inline Vector<String> tokenize(const String_View str)
 {
     if(str.empty()){
         return {};
     }
     Vector<String> result;
-    int off {0};
-    auto find {str.find(" ")};
+    size_t off {0};
+    auto find {str.find(' ')};
     if(find == str.npos){
-        result.push_back(str);
+        result.push_back(String{str});
     }
     else
     {
         while(find != str.npos)
         {
-            result.push_back(str.substr(off, find - off));
+            result.push_back(String{str.substr(off, find - off)});
             off = find + 1;
-            find = str.find(" ", off);
+            find = str.find(' ', off);
         }
         if(off < str.length()){
-            result.push_back(str.substr(off, str.npos));
+            result.push_back(String{str.substr(off, str.npos)});
         }
     }
     for(auto& s : result){
@@ -136,32 +206,76 @@ inline Vector<String> tokenize(const String& str)
 
 }
 
-inline String wrap_in_quotes(const String& s)
+// fnv-1a
+constexpr u64 hash_string(const String_View s)
 {
-    return '"' + (s) + '"';
+    u64 hash {14695981039346656037ull};
+    for(const auto c : s)
+    {
+        hash ^= (u8)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
 }
 
-inline int string_to_int(const String& s)
+// unix seconds for a utc timestamp like 2022-05-24T22:22:08Z as twitch sends them, 0 if it isn't one
+inline s64 parse_timestamp(const String_View s)
 {
-    std::stringstream ss {s};
-    int res;
-    ss>>res;
-    return res;
+    auto digits {[&s](const size_t at, const size_t count)
+    {
+        s64 result {0};
+        for(size_t i = at; i < at + count; i++)
+        {
+            if(i >= s.size() || s[i] < '0' || s[i] > '9'){
+                return (s64)-1;
+            }
+            result = result * 10 + (s[i] - '0');
+        }
+        return result;
+    }};
+    const auto year   {digits(0, 4)};
+    const auto month  {digits(5, 2)};
+    const auto day    {digits(8, 2)};
+    const auto hour   {digits(11, 2)};
+    const auto minute {digits(14, 2)};
+    const auto second {digits(17, 2)};
+    if(year < 1970 || month < 1 || month > 12 || day < 1 || day > 31 || hour < 0 || minute < 0 || second < 0){
+        return 0;
+    }
+
+    // days since 1970 from the civil date, march based years put the leap day last
+    const auto y   {month <= 2 ? year - 1 : year};
+    const auto era {y / 400};
+    const auto yoe {y - era * 400};
+    const auto doy {(153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1};
+    const auto doe {yoe * 365 + yoe / 4 - yoe / 100 + doy};
+    const auto days {era * 146097 + doe - 719468};
+    return days * 86400 + hour * 3600 + minute * 60 + second;
 }
 
+// all of s has to be the number, no sign for unsigned types and no white space.
+// false leaves out alone when s is empty, has anything else in it or doesn't fit in T
 template<typename T>
-inline T string_to_int(const String& s)
+inline bool string_to_int(const String_View s, T* out)
 {
-    std::stringstream ss {s};
-    T res;
-    ss>>res;
-    return res;
+    T result;
+    const auto end {s.data() + s.size()};
+    const auto parsed {std::from_chars(s.data(), end, result)};
+    if(parsed.ec != std::errc{} || parsed.ptr != end){
+        return false;
+    }
+    *out = result;
+    return true;
 }
 
-inline float string_to_float(const String& s)
+inline bool string_to_float(const String_View s, float* out)
 {
-    std::stringstream ss {s};
-    float res;
-    ss>>res;
-    return res;
+    float result;
+    const auto end {s.data() + s.size()};
+    const auto parsed {std::from_chars(s.data(), end, result)};
+    if(parsed.ec != std::errc{} || parsed.ptr != end){
+        return false;
+    }
+    *out = result;
+    return true;
 }
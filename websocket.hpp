@@ -8,8 +8,10 @@
 
 #include "websocketpp/client.hpp"
 
+#include <sstream>
 #include "types.hpp"
 #include "utilities.hpp"
+#include "queue.hpp"
 
 using Client = websocketpp::client<websocketpp::config::asio_tls_client>;
 using Connection_Handle = websocketpp::connection_hdl;
@@ -62,8 +64,12 @@ struct Connection_Metadata
         printf("%s\n", reason.c_str());
     }
 
-    void on_message(Connection_Handle, Client::message_ptr msg){
+    void on_message(Connection_Handle, Client::message_ptr msg)
+    {
         on_message_handler(this, msg);
+        if(message_event){
+            message_event->notify();
+        }
     }
 
     int id;
@@ -75,11 +81,12 @@ struct Connection_Metadata
     String name;
 
     On_Message_Handler on_message_handler;
-    std::mutex message_mutex;
+    Event* message_event {nullptr};
     std::mutex opened_mutex;
     std::condition_variable opened_condition_variable;
 
-    Vector<String> messages;
+    // filled by the websocket thread, drained by the bot's message thread
+    Spsc_Queue<String, 4096> messages;
     String reason;
 
     std::atomic<bool> joined {false};
@@ -124,7 +131,7 @@ struct Websocket_Endpoint
         thread = websocketpp::lib::make_shared<websocketpp::lib::thread>(&Client::run, &end_point);
     }
 
-    int connect(const String& uri, const String& name, Connection_Metadata::On_Message_Handler omh)
+    int connect(const String& uri, const String& name, Connection_Metadata::On_Message_Handler omh, Event* message_event = nullptr)
     {
         websocketpp::lib::error_code ec;
 
@@ -141,6 +148,7 @@ struct Websocket_Endpoint
         connection_list[new_id] = metadata_ptr.get();
         metadata_ptr->name = name;
         metadata_ptr->on_message_handler = omh;
+        metadata_ptr->message_event = message_event;
 
         con->set_open_handler(websocketpp::lib::bind(
             &Connection_Metadata::on_open,
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "types.hpp"
+#include <functional>
+#include <thread>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+// fixed set of threads, each with its own queue. an idle worker steals from the back of the others.
+// delayed tasks sit in a heap on a timer thread until they are due and then go through submit
+struct Worker_Pool
+{
+    using Task = std::function<void()>;
+
+    Worker_Pool(const int thread_count) : workers(std::max(thread_count, 1))
+    {
+        for(size_t i = 0; i < workers.size(); i++){
+            workers[i].thread = std::thread(&Worker_Pool::work, this, i);
+        }
+        timer_thread = std::thread(&Worker_Pool::time, this);
+    }
+
+    ~Worker_Pool()
+    {
+        {
+            std::scoped_lock l {sleep_mutex};
+            stopping = true;
+        }
+        sleep_condition_variable.notify_all();
+        {
+            std::scoped_lock l {timer_mutex};
+        }
+        timer_condition_variable.notify_all();
+
+        for(auto& w : workers){
+            w.thread.join();
+        }
+        timer_thread.join();
+    }
+
+    void submit(Task task)
+    {
+        const auto i {next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size()};
+        {
+            std::scoped_lock l {workers[i].mutex};
+            // counted before it's visible, a worker that takes it right away must not take pending below zero
+            const auto depth {pending.fetch_add(1) + 1};
+            if(depth > peak.load(std::memory_order_relaxed)){
+                peak.store(depth, std::memory_order_relaxed);
+            }
+            workers[i].tasks.push_back(std::move(task));
+        }
+        {
+            std::scoped_lock l {sleep_mutex};
+        }
+        sleep_condition_variable.notify_one();
+    }
+
+    void submit_after(const float seconds, Task task)
+    {
+        {
+            std::scoped_lock l {timer_mutex};
+            const auto due {Clock::now() + std::chrono::duration_cast<Clock::duration>(Duration{seconds})};
+            delayed.push_back({due, std::move(task)});
+            std::push_heap(delayed.begin(), delayed.end(), later);
+        }
+        timer_condition_variable.notify_one();
+    }
+
+    // tasks submitted but not started yet
+    size_t queue_depth() const
+    {
+        return pending.load();
+    }
+
+    size_t high_water_mark() const
+    {
+        return peak.load(std::memory_order_relaxed);
+    }
+
+    private:
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+            std::thread thread;
+        };
+
+        struct Delayed_Task
+        {
+            Stamp due;
+            Task task;
+        };
+
+        static bool later(const Delayed_Task& a, const Delayed_Task& b)
+        {
+            return a.due > b.due;
+        }
+
+        bool take(const size_t i, Task* task)
+        {
+            {
+                auto& own {workers[i]};
+                std::scoped_lock l {own.mutex};
+                if(!own.tasks.empty())
+                {
+                    *task = std::move(own.tasks.front());
+                    own.tasks.pop_front();
+                    return true;
+                }
+            }
+            for(size_t j = 1; j < workers.size(); j++)
+            {
+                auto& victim {workers[(i + j) % workers.size()]};
+                std::scoped_lock l {victim.mutex};
+                if(!victim.tasks.empty())
+                {
+                    *task = std::move(victim.tasks.back());
+                    victim.tasks.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void work(const size_t i)
+        {
+            Task task;
+            while(true)
+            {
+                if(take(i, &task))
+                {
+                    pending--;
+                    task();
+                    task = {};
+                    continue;
+                }
+                std::unique_lock l {sleep_mutex};
+                sleep_condition_variable.wait(l, [&]{
+                    return stopping || pending > 0;
+                });
+                if(stopping){
+                    return;
+                }
+            }
+        }
+
+        void time()
+        {
+            std::unique_lock l {timer_mutex};
+            while(true)
+            {
+                {
+                    std::scoped_lock s {sleep_mutex};
+                    if(stopping){
+                        return;
+                    }
+                }
+                if(delayed.empty()){
+                    timer_condition_variable.wait(l);
+                }
+                else if(Clock::now() < delayed.front().due){
+                    timer_condition_variable.wait_until(l, delayed.front().due);
+                }
+                else
+                {
+                    std::pop_heap(delayed.begin(), delayed.end(), later);
+                    auto task {std::move(delayed.back().task)};
+                    delayed.pop_back();
+                    l.unlock();
+                    submit(std::move(task));
+                    l.lock();
+                }
+            }
+        }
+
+        Vector<Worker> workers;
+        std::atomic<size_t> next_worker {0};
+        std::atomic<size_t> pending {0};
+        std::atomic<size_t> peak {0};
+
+        std::mutex sleep_mutex;
+        std::condition_variable sleep_condition_variable;
+        bool stopping {false};
+
+        std::thread timer_thread;
+        std::mutex timer_mutex;
+        std::condition_variable timer_condition_variable;
+        Vector<Delayed_Task> delayed;
+};
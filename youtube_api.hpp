@@ -1,115 +1,266 @@
 #pragma once
 
 #include "types.hpp"
-#include <sstream>
+#include <fstream>
+#include <charconv>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <ctime>
 #include "utilities.hpp"
+#include "json.hpp"
 
 struct Youtube_Video_Info
 {
     String title    {};
     String iso_8601_duration;
-    int like_count  {-1};
-    int view_count  {-1};
+    s64 like_count  {-1};
+    s64 view_count  {-1};
     size_t duration {0};
 };
 
-Youtube_Video_Info parse_youtube_api_result(const String& s)
+// seconds in a duration like PT3M33S or P1W2DT4H, -1 if it isn't one. years and months have no fixed length so they're
+// refused, so are units that repeat or come out of order and a T with nothing after it
+constexpr s64 iso_8601_duration_seconds(const String_View s)
 {
-    String line;
-    std::stringstream ss {s};
-
-    auto get_content {[](const String& l)
-    {
-        auto colon {l.find(':')};
-        auto first_comma {l.find('"', colon + 1)};
-        auto second_comma {l.find('"', first_comma + 1)};
-        return l.substr(first_comma + 1, (second_comma - first_comma) - 1);
-    }};
-
-    auto convert_iso_8601_to_seconds {[](const String& s)
+    if(s.size() < 2 || s[0] != 'P'){
+        return -1;
+    }
+    s64 result {0};
+    s64 value {0};
+    auto digits {false};
+    auto time {false};
+    // W D H M S count up from 1, each unit has to rank above the one before it
+    int rank {0};
+    for(size_t i = 1; i < s.size(); i++)
     {
-        auto get_number_component {[&s](size_t ctr)
+        const auto c {s[i]};
+        if(c >= '0' && c <= '9')
         {
-            String value;
-            
-            while(isdigit(s[ctr]))
-            {
-                value = s[ctr] + value;
-                ctr--;
-            }
-            return string_to_int(value);
-        }};
-
-        int day_value     {0};
-        int hours_value   {0};
-        int minutes_value {0};
-        int seconds_value {0};
-
-        auto key {s.find("DT")};
-        if(key != s.npos){
-            day_value = get_number_component(key - 1);
+            value = value * 10 + (c - '0');
+            digits = true;
+            continue;
         }
-        key = s.find('H');
-        if(key != s.npos){
-            hours_value = get_number_component(key - 1);
+        if(c == 'T' && !time && !digits)
+        {
+            time = true;
+            continue;
         }
-        key = s.find('M');
-        if(key != s.npos){
-            minutes_value = get_number_component(key - 1);
+        if(!digits){
+            return -1;
         }
-        key = s.find('S');
-        if(key != s.npos){
-            seconds_value = get_number_component(key - 1);
+        s64 unit {0};
+        int unit_rank {0};
+        if(!time && c == 'W')
+        {
+            unit = 7 * 24 * 60 * 60;
+            unit_rank = 1;
         }
-        return (day_value * 24 * 60 * 60) + (hours_value * 60 * 60) + (minutes_value * 60) + seconds_value;
-    }};
-
-    Youtube_Video_Info result;
-
-    auto entered_snippet         {false};
-    auto entered_content_details {false};
-    auto entered_statistics      {false};
-
-    while(std::getline(ss, line))
-    {
-        if(line.find("snippet") != String::npos){
-            entered_snippet = true;
+        else if(!time && c == 'D')
+        {
+            unit = 24 * 60 * 60;
+            unit_rank = 2;
         }
-        else if(line.find("contentDetails") != String::npos)
+        else if(time && c == 'H')
         {
-            entered_content_details = true;
-            entered_snippet = false;
+            unit = 60 * 60;
+            unit_rank = 3;
         }
-        else if(line.find("statistics") != String::npos)
+        else if(time && c == 'M')
         {
-            entered_content_details = false;
-            entered_snippet = false;
-            entered_statistics = true;
+            unit = 60;
+            unit_rank = 4;
         }
-        if(entered_snippet)
+        else if(time && c == 'S')
         {
-            if(line.find("title") != String::npos){
-                result.title = get_content(line);
-            }
+            unit = 1;
+            unit_rank = 5;
         }
-        else if(entered_content_details)
+        if(unit_rank <= rank){
+            return -1;
+        }
+        result += value * unit;
+        value = 0;
+        digits = false;
+        rank = unit_rank;
+    }
+    // after a T there has to be at least an H M or S
+    if(digits || rank == 0 || (time && rank < 3)){
+        return -1;
+    }
+    return result;
+}
+
+static_assert(iso_8601_duration_seconds("PT3M33S") == 213);
+static_assert(iso_8601_duration_seconds("PT1H") == 3600);
+static_assert(iso_8601_duration_seconds("PT10M0S") == 600);
+static_assert(iso_8601_duration_seconds("P1DT2H3M4S") == 93784);
+static_assert(iso_8601_duration_seconds("P2W") == 1209600);
+static_assert(iso_8601_duration_seconds("P1W1D") == 691200);
+static_assert(iso_8601_duration_seconds("P0D") == 0);
+static_assert(iso_8601_duration_seconds("PT0S") == 0);
+static_assert(iso_8601_duration_seconds("P1M") == -1);
+static_assert(iso_8601_duration_seconds("PT") == -1);
+static_assert(iso_8601_duration_seconds("PT5") == -1);
+static_assert(iso_8601_duration_seconds("") == -1);
+static_assert(iso_8601_duration_seconds("PT1H1H") == -1);
+static_assert(iso_8601_duration_seconds("PT3S4M") == -1);
+static_assert(iso_8601_duration_seconds("P1DT") == -1);
+static_assert(iso_8601_duration_seconds("P1D2W") == -1);
+
+// the first video of a videos.list response with part=snippet,contentDetails,statistics
+inline Youtube_Video_Info parse_youtube_api_result(const String_View s)
+{
+    Json_Value title;
+    Json_Value duration;
+    Json_Value view_count;
+    Json_Value like_count;
+    json_read(s, {{"items.0.snippet.title", &title},
+                  {"items.0.contentDetails.duration", &duration},
+                  {"items.0.statistics.viewCount", &view_count},
+                  {"items.0.statistics.likeCount", &like_count}});
+
+    // the counts come as strings
+    auto count {[](const Json_Value& v)
+    {
+        s64 result {-1};
+        const auto text {v.view()};
+        std::from_chars(text.data(), text.data() + text.size(), result);
+        return result;
+    }};
+
+    Youtube_Video_Info result;
+    result.title = title.string();
+    result.iso_8601_duration = duration.string();
+    const auto seconds {iso_8601_duration_seconds(duration.view())};
+    result.duration = seconds > 0 ? (size_t)seconds : 0;
+    result.view_count = count(view_count);
+    result.like_count = count(like_count);
+    return result;
+}
+
+// lookups by video id, kept in memory and appended to a file so a restart doesn't start cold.
+// entries older than ttl are fetched again, the file only ever has live entries right after load
+struct Youtube_Cache
+{
+    Youtube_Cache(const String& path, const s64 ttl_seconds) : file_name {path}, ttl {ttl_seconds}
+    {
+    }
+
+    void load()
+    {
+        std::scoped_lock l {mutex};
+        String line;
+        String tag;
+        String value;
         {
-            if(line.find("duration") != String::npos)
+            std::ifstream file {file_name};
+            Entry* current {nullptr};
+            while(std::getline(file, line))
             {
-                auto d {get_content(line)};
-                result.iso_8601_duration = d;
-                result.duration = convert_iso_8601_to_seconds(d);
+                clean_line(&line);
+                if(line.empty()){
+                    continue;
+                }
+                extract_tag_and_value_from_line(line, &tag, &value);
+                if(tag == "Video"){
+                    current = &entries[value];
+                }
+                else if(!current){
+                    continue;
+                }
+                else if(tag == "Title"){
+                    current->info.title = value;
+                }
+                else if(tag == "Iso_8601_Duration"){
+                    current->info.iso_8601_duration = value;
+                }
+                else if(tag == "Duration"){
+                    string_to_int(value, &current->info.duration);
+                }
+                else if(tag == "Like_Count"){
+                    string_to_int(value, &current->info.like_count);
+                }
+                else if(tag == "View_Count"){
+                    string_to_int(value, &current->info.view_count);
+                }
+                else if(tag == "Fetched_At"){
+                    string_to_int(value, &current->fetched_at);
+                }
             }
         }
-        else if(entered_statistics)
+
+        const auto now {(s64)std::time(nullptr)};
+        for(auto i = entries.begin(); i != entries.end();)
         {
-            if(line.find("viewCount") != String::npos){
-                result.view_count = string_to_int(get_content(line));
+            if(now - i->second.fetched_at >= ttl){
+                i = entries.erase(i);
             }
-            else if(line.find("likeCount") != String::npos){
-                result.like_count = string_to_int(get_content(line));
+            else{
+                i++;
             }
         }
+
+        std::ofstream file {file_name, std::ios::trunc};
+        for(const auto& e : entries){
+            write(&file, e.first, e.second);
+        }
     }
-    return result;
+
+    bool get(const String& id, Youtube_Video_Info* out)
+    {
+        lookups++;
+        std::scoped_lock l {mutex};
+        auto found {entries.find(id)};
+        if(found == entries.end() || (s64)std::time(nullptr) - found->second.fetched_at >= ttl){
+            return false;
+        }
+        hits++;
+        *out = found->second.info;
+        return true;
+    }
+
+    void put(const String& id, const Youtube_Video_Info& info)
+    {
+        std::scoped_lock l {mutex};
+        auto& e {entries[id]};
+        e.info = info;
+        e.fetched_at = std::time(nullptr);
+        std::ofstream file {file_name, std::ios::app};
+        write(&file, id, e);
+    }
+
+    // hits out of lookups as a percentage
+    float hit_ratio() const
+    {
+        const auto l {lookups.load()};
+        return l > 0 ? hits.load() * 100.f / l : 0.f;
+    }
+
+    std::atomic<u64> lookups {0};
+    std::atomic<u64> hits {0};
+
+    private:
+        struct Entry
+        {
+            Youtube_Video_Info info;
+            s64 fetched_at {0};
+        };
+
+        static void write(std::ostream* out, const String& id, const Entry& e)
+        {
+            auto& o {*out};
+            o<<"Video : "<<id<<"\n\n";
+            o<<"\tTitle : "<<e.info.title<<"\n\n";
+            o<<"\tIso_8601_Duration : "<<e.info.iso_8601_duration<<"\n\n";
+            o<<"\tDuration : "<<e.info.duration<<"\n\n";
+            o<<"\tLike_Count : "<<e.info.like_count<<"\n\n";
+            o<<"\tView_Count : "<<e.info.view_count<<"\n\n";
+            o<<"\tFetched_At : "<<e.fetched_at<<"\n\n";
+        }
+
+        String file_name;
+        s64 ttl;
+        std::mutex mutex;
+        std::unordered_map<String, Entry> entries;
 };